@@ -0,0 +1,76 @@
+'''
+FlashAlgo
+Copyright (c) 2011-2017 ARM Limited
+
+Licensed under the Apache License, Version 2.0 (the 'License');
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an 'AS IS' BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Host side of the HashBlocks entry point. Computes the same per block weak
+and strong hashes for a new image so that only the blocks which differ
+from the current flash contents need to be sent and programmed.
+'''
+import argparse
+import zlib
+
+
+def weak_hash(data):
+    """rsync style checksum, a | b << 16"""
+    a = 0
+    b = 0
+    for byte in bytearray(data):
+        a += byte
+        b += a
+    return (a & 0xFFFF) | ((b & 0xFFFF) << 16)
+
+
+def block_hashes(data, blk):
+    """Return a (weak, strong) pair per block, as stored by HashBlocks"""
+    hashes = []
+    for start in range(0, len(data), blk):
+        block = data[start:start + blk]
+        hashes.append((weak_hash(block), zlib.crc32(bytes(block)) & 0xFFFFFFFF))
+    return hashes
+
+
+def changed_blocks(target_words, data, blk):
+    """
+    Return the offsets of blocks in data which differ from flash
+
+    :param target_words: words written to out by HashBlocks
+    :param data: new image for the same address range
+    :param blk: block size passed to HashBlocks
+    """
+    target = list(zip(target_words[0::2], target_words[1::2]))
+    changed = []
+    for index, pair in enumerate(block_hashes(data, blk)):
+        if index >= len(target) or target[index] != pair:
+            changed.append(index * blk)
+    return changed
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Block hashes of a binary image")
+    parser.add_argument("bin_path", help="Binary image to hash")
+    parser.add_argument("--blk", default=0x400, type=lambda val: int(val, 0),
+                        help="Block size in bytes")
+    args = parser.parse_args()
+
+    with open(args.bin_path, "rb") as file_handle:
+        data = bytearray(file_handle.read())
+
+    for index, (weak, strong) in enumerate(block_hashes(data, args.blk)):
+        print("0x%08x 0x%08x 0x%08x" % (index * args.blk, weak, strong))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,134 @@
+'''
+FlashAlgo
+Copyright (c) 2011-2017 ARM Limited
+
+Licensed under the Apache License, Version 2.0 (the 'License');
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an 'AS IS' BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Differential check of two builds of an algo. Each build is run on the same
+workload, on a target or under an emulator, and the run is recorded as:
+
+    image: dense.bin            # final flash contents, relative to this file
+    image_start: 0x08000000
+    erased: 0xFF                # valEmpty from FlashDev.c, 0x00 on STM32L0/L1
+    calls:                      # algo calls in order
+        - [EraseSector, 0x08000000, 0]      # name, first argument, return
+        - [ProgramPage, 0x08000000, 0]
+    commands:                   # controller commands seen on the bus
+        - [erase, 0x08000000, 0x4000]       # kind, address, size
+        - [program, 0x08000000, 0x400]
+
+The optimized run passes when its final image and return codes match the
+baseline, it erased everything the baseline erased, and it programmed
+every byte the baseline programmed unless the byte is left erased. The
+sparse paths skip erased data, so programming coverage may shrink there.
+Return codes are compared per function since a batching build makes fewer
+calls. With --strict the command sequences must match exactly.
+'''
+import argparse
+import os
+import sys
+import yaml
+
+# Erased value when the run record has none
+ERASED = 0xFF
+
+
+def load_run(path):
+    """Return the run record with the final image read in"""
+    with open(path) as file_handle:
+        run = yaml.safe_load(file_handle)
+    image = os.path.join(os.path.dirname(path), run['image'])
+    with open(image, "rb") as file_handle:
+        run['data'] = bytearray(file_handle.read())
+    run.setdefault('erased', ERASED)
+    run.setdefault('calls', [])
+    run.setdefault('commands', [])
+    return run
+
+
+def ranges(addresses):
+    """Collapse sorted addresses into [start, end) ranges"""
+    out = []
+    for adr in addresses:
+        if out and out[-1][1] == adr:
+            out[-1][1] = adr + 1
+        else:
+            out.append([adr, adr + 1])
+    return out
+
+
+def coverage(run, kind):
+    """Set of addresses touched by commands of one kind"""
+    covered = set()
+    for cmd_kind, adr, size in run['commands']:
+        if cmd_kind == kind:
+            covered.update(range(adr, adr + size))
+    return covered
+
+
+def compare(base, opt, strict=False):
+    """Return a list of differences, empty when the runs are equivalent"""
+    errors = []
+
+    start = base['image_start']
+    if opt['erased'] != base['erased']:
+        errors.append("erased: 0x%02x vs 0x%02x" % (base['erased'], opt['erased']))
+    if opt['image_start'] != start or len(opt['data']) != len(base['data']):
+        errors.append("image: different extent")
+    else:
+        diff = [start + i for i in range(len(base['data']))
+                if base['data'][i] != opt['data'][i]]
+        for first, end in ranges(diff)[:8]:
+            errors.append("image: differs at [0x%08x, 0x%08x)" % (first, end))
+
+    base_calls = [(name, rc) for name, _, rc in base['calls']]
+    opt_calls = [(name, rc) for name, _, rc in opt['calls']]
+    if sorted(set(base_calls)) != sorted(set(opt_calls)):
+        errors.append("calls: return codes differ, %s vs %s" %
+                      (sorted(set(base_calls)), sorted(set(opt_calls))))
+
+    missing = coverage(base, 'erase') - coverage(opt, 'erase')
+    for first, end in ranges(sorted(missing))[:8]:
+        errors.append("erase: [0x%08x, 0x%08x) not erased" % (first, end))
+
+    def erased(adr):
+        return base['data'][adr - start] == base['erased']
+    missing = [adr for adr in coverage(base, 'program') - coverage(opt, 'program')
+               if not (start <= adr < start + len(base['data']) and erased(adr))]
+    for first, end in ranges(sorted(missing))[:8]:
+        errors.append("program: [0x%08x, 0x%08x) not programmed" % (first, end))
+
+    if strict and base['commands'] != opt['commands']:
+        errors.append("commands: sequences differ")
+    return errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare two algo runs')
+    parser.add_argument("baseline", help="Run record of the baseline build")
+    parser.add_argument("optimized", help="Run record of the optimized build")
+    parser.add_argument("--strict", action="store_true",
+                        help="Require identical controller command sequences")
+    args = parser.parse_args()
+
+    errors = compare(load_run(args.baseline), load_run(args.optimized),
+                     args.strict)
+    for error in errors:
+        print(error)
+    print("equivalent" if not errors else "%d difference(s)" % len(errors))
+    sys.exit(1 if errors else 0)
+
+
+if __name__ == '__main__':
+    main()
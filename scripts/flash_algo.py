@@ -67,7 +67,14 @@ class PackFlashAlgo(object):
 
     EXTRA_SYMBOLS = set([
         "BlankCheck",
+        "CopyFlash",
         "EraseChip",
+        "FlashJournal",
+        "FlashTiming",
+        "HashBlocks",
+        "ProgramPartial",
+        "ProgramFill",
+        "SurveySectors",
         "Verify",
     ])
 
@@ -95,7 +102,8 @@ class PackFlashAlgo(object):
 
         ro_rw_zi = _find_sections(self.elf, sections_to_find)
         ro_rw_zi = _algo_fill_zi_if_missing(ro_rw_zi)
-        error_msg = _algo_check_for_section_problems(ro_rw_zi)
+        error_msg = _algo_check_for_section_problems(ro_rw_zi,
+                                                     self.elf.symbols)
         if error_msg is not None:
             raise Exception(error_msg)
 
@@ -109,7 +117,7 @@ class PackFlashAlgo(object):
 
         self.algo_data = _create_algo_bin(ro_rw_zi)
 
-    def format_algo_data(self, spaces, group_size, fmt):
+    def format_algo_data(self, spaces, group_size, fmt, include_zi=False):
         """"
         Return a string representing algo_data suitable for use in a template
 
@@ -119,16 +127,21 @@ class PackFlashAlgo(object):
         :param group_size: number of elements per line (element type
             depends of format)
         :param fmt: - format to create - can be either "hex" or "c"
+        :param include_zi: append the zero initialized region to the
+            blob, for loaders which do not clear it on the target
         """
         padding = " " * spaces
+        algo_data = self.algo_data
+        if include_zi:
+            algo_data = algo_data + bytearray(self.zi_size)
         if fmt == "hex":
-            blob = binascii.b2a_hex(self.algo_data)
+            blob = binascii.b2a_hex(algo_data)
             line_list = []
             for i in xrange(0, len(blob), group_size):
                 line_list.append('"' + blob[i:i + group_size] + '"')
             return ("\n" + padding).join(line_list)
         elif fmt == "c":
-            blob = self.algo_data[:]
+            blob = algo_data[:]
             pad_size = 0 if len(blob) % 4 == 0 else 4 - len(blob) % 4
             blob = blob + "\x00" * pad_size
             integer_list = struct.unpack("<" + "L" * (len(blob) / 4), blob)
@@ -213,7 +226,7 @@ def _algo_fill_zi_if_missing(ro_rw_zi):
     return s_ro, s_rw, s_zi
 
 
-def _algo_check_for_section_problems(ro_rw_zi):
+def _algo_check_for_section_problems(ro_rw_zi, symbols):
     """Return a string describing any errors with the layout or None if good"""
     s_ro, s_rw, s_zi = ro_rw_zi
     if s_ro is None:
@@ -228,13 +241,22 @@ def _algo_check_for_section_problems(ro_rw_zi):
         return "RW section does not follow RO section"
     if s_rw["sh_addr"] + s_rw["sh_size"] != s_zi["sh_addr"]:
         return "ZI section does not follow RW section"
+    # GOT entries hold link time addresses and are never relocated by the
+    # debugger, so all data must be reached PC relative instead
+    if "_GLOBAL_OFFSET_TABLE_" in symbols:
+        return "GOT is present, make globals static or hidden"
     return None
 
 
 def _create_algo_bin(ro_rw_zi):
-    """Create a binary blob of the flash algo which can execute from ram"""
-    sect_ro, sect_rw, sect_zi = ro_rw_zi
-    algo_size = sect_ro["sh_size"] + sect_rw["sh_size"] + sect_zi["sh_size"]
+    """
+    Create a binary blob of the flash algo which can execute from ram
+
+    Only RO and RW are included. The ZI section directly follows RW and
+    must be cleared on the target before the algo is first called.
+    """
+    sect_ro, sect_rw, _ = ro_rw_zi
+    algo_size = sect_ro["sh_size"] + sect_rw["sh_size"]
     algo_data = bytearray(algo_size)
     for section in (sect_ro, sect_rw):
         start = section["sh_addr"]
@@ -23,44 +23,238 @@ and python programs (DAPLink Interface Firmware and pyDAPFlash)
 '''
 import os
 import argparse
+import zlib
+import records
+import stack_usage
 from flash_algo import PackFlashAlgo
 
 # TODO
 # FIXED LENGTH - remove and these (shrink offset to 4 for bkpt only)
 BLOB_HEADER = '0xE00ABE00, 0x062D780D, 0x24084068, 0xD3000040, 0x1E644058, 0x1C49D1FA, 0x2A001E52, 0x4770D1F2,'
-HEADER_SIZE = 0x20
 
+# The ZI section is not part of the blob. Init is entered through this stub
+# which zeroes ZI on the first call after download and then jumps to Init.
+# Arguments in r0-r2 and lr are preserved. The four words following the code
+# are filled per algo: first-call flag, ZI offset and size (both relative to
+# the flag word), and the Init address (thumb) relative to the flag word.
+#
+#       push  {r0, r1, r2}
+#       adr   r3, flag
+#       ldr   r0, [r3, #0]
+#       cmp   r0, #0
+#       beq   done
+#       movs  r0, #0
+#       str   r0, [r3, #0]
+#       ldr   r1, [r3, #4]
+#       adds  r1, r1, r3
+#       ldr   r2, [r3, #8]
+#   loop:
+#       cmp   r2, #0
+#       beq   done
+#       stmia r1!, {r0}
+#       subs  r2, r2, #4
+#       b     loop
+#   done:
+#       ldr   r0, [r3, #12]
+#       adds  r3, r3, r0
+#       pop   {r0, r1, r2}
+#       bx    r3
+#       nop
+#   flag:
+ZI_INIT_STUB = '0xA309B407, 0x28006818, 0x2000D009, 0x68596018, 0x689A18C9, 0xD0022A00, 0x1F12C101, 0x68D8E7FA, 0xBC07181B, 0xBF004718,'
+ZI_INIT_OFFSET = 0x20
+ZI_INIT_FLAG = 0x48
+
+# Identify returns the build ID if the RO part of the resident blob still
+# matches the CRC recorded at generation time, or 0 otherwise. Calling it
+# runs whatever is in RAM, so a host first reads the HEADER_SIZE bytes at
+# load_address and compares them with the header of this blob, skipping the
+# ZI flag word at ZI_INIT_FLAG which the first Init clears. The header holds
+# the stub code, the CRC and the build ID. Only if it matches does the host
+# call Identify to check RO, and on the expected build ID skip the download.
+# RW and ZI change while the algo runs and are not covered, their state from
+# the previous session is trusted as is. The CRC is computed with the
+# routine at offset 0x02 of BLOB_HEADER (MSB first, poly 0x04C11DB7, initial
+# value 0xFFFFFFFF, no final xor). The five words following the code hold the
+# RO offset (relative to the first word) and size, the polynomial, the
+# expected CRC and the build ID.
+#
+#       push  {r4, r5, r6, lr}
+#       adr   r6, ro_offset
+#       ldr   r1, [r6, #0]
+#       adds  r1, r1, r6
+#       ldr   r2, [r6, #4]
+#       ldr   r3, [r6, #8]
+#       movs  r0, #0
+#       mvns  r0, r0
+#       bl    crc
+#       ldr   r1, [r6, #12]
+#       cmp   r0, r1
+#       bne   fail
+#       ldr   r0, [r6, #16]
+#       pop   {r4, r5, r6, pc}
+#   fail:
+#       movs  r0, #0
+#       pop   {r4, r5, r6, pc}
+#       nop
+#   ro_offset:
+IDENTIFY_STUB = '0xA608B570, 0x19896831, 0x68B36872, 0x43C02000, 0xFFCBF7FF, 0x428868F1, 0x6930D101, 0x2000BD70, 0xBF00BD70,'
+IDENTIFY_OFFSET = 0x58
+IDENTIFY_DATA = 0x7C
+CRC_POLY = 0x04C11DB7
+HEADER_SIZE = 0x90
+
+# Used when there is no call graph to size the stack from
 STACK_SIZE = 0x200
+DEFAULT_BLOB_START = 0x20000000
 
 def str_to_num(val):
     return int(val,0)  #convert string to number and automatically handle hex conversion
 
+def crc32_msb(data, crc=0xFFFFFFFF):
+    """CRC matching the routine in BLOB_HEADER"""
+    for byte in bytearray(data):
+        crc ^= byte << 24
+        for _ in range(8):
+            crc = ((crc << 1) ^ CRC_POLY if crc & 0x80000000 else crc << 1) & 0xFFFFFFFF
+    return crc
+
+def load_ram_layout(project):
+    """Merge the ram_layout entries of a project's records
+
+    A record can place the blob (code, RW and ZI data), the stack and the
+    page buffers in different RAM regions, for example code in SRAM on the
+    code bus and buffers in SRAM on the system bus:
+
+        ram_layout:
+            code: 0x1FFF0000
+            stack: 0x20000000
+            buffers: 0x20001000
+            stack_size: 0x300
+
+    Missing entries keep the default placement after the blob. The stack is
+    STACK_SIZE, or more if the call graph of a GCC build needs it, unless
+    stack_size is given.
+    """
+    return records.load_entry(project, 'ram_layout')
+
+def check_overlap(regions):
+    """Fail if any two of the (name, start, size) regions overlap"""
+    for i, (name_a, start_a, size_a) in enumerate(regions):
+        for name_b, start_b, size_b in regions[i + 1:]:
+            if start_a < start_b + size_b and start_b < start_a + size_a:
+                raise Exception("RAM layout: %s [0x%08x, 0x%08x) overlaps %s [0x%08x, 0x%08x)" %
+                                (name_a, start_a, start_a + size_a,
+                                 name_b, start_b, start_b + size_b))
+
 def main():
     parser = argparse.ArgumentParser(description="Blob generator")
     parser.add_argument("elf_path", help="Elf, axf, or flm to extract "
                         "flash algo from")
-    parser.add_argument("--blob_start", default=0x20000000, type=str_to_num, help="Starting "
+    parser.add_argument("--blob_start", default=None, type=str_to_num, help="Starting "
                         "address of the flash blob. Used only for DAPLink.")
+    parser.add_argument("--stack_start", default=None, type=str_to_num, help="Lowest "
+                        "address of the stack, placed after the blob by default.")
+    parser.add_argument("--buffer_start", default=None, type=str_to_num, help="Starting "
+                        "address of the page buffers, placed after the blob by default.")
+    parser.add_argument("--stack_usage", default=None, help="Directory holding "
+                        "the .ci call graph files, defaults to the elf directory.")
+    parser.add_argument("--project", default=None, help="Project to read ram_layout "
+                        "from, defaults to the elf file name.")
     args = parser.parse_args()
 
     with open(args.elf_path, "rb") as file_handle:
-        algo = PackFlashAlgo(file_handle.read())
+        elf_data = file_handle.read()
+        algo = PackFlashAlgo(elf_data)
 
     print(algo.flash_info)
 
     template_dir = os.path.dirname(os.path.realpath(__file__))
     output_dir = os.path.dirname(args.elf_path)
 
-    # Allocate stack after algo and its rw data, rounded up.
-    SP = args.blob_start + HEADER_SIZE + algo.rw_start + algo.rw_size + STACK_SIZE
-    SP = (SP + 0x100 - 1) // 0x100 * 0x100
+    # Command line arguments override the records, the default is to pack
+    # everything from DEFAULT_BLOB_START.
+    project = args.project or os.path.splitext(os.path.basename(args.elf_path))[0]
+    layout = load_ram_layout(project)
+    blob_start = args.blob_start
+    if blob_start is None:
+        blob_start = layout.get('code', DEFAULT_BLOB_START)
+    stack_start = args.stack_start
+    if stack_start is None:
+        stack_start = layout.get('stack')
+    buffer_start = args.buffer_start
+    if buffer_start is None:
+        buffer_start = layout.get('buffers')
+    blob_size = HEADER_SIZE + algo.zi_start + algo.zi_size
+
+    # Worst case depth of the entry points, see stack_usage.py. The ROM
+    # and library allowances are estimates, so the analysis only grows the
+    # stack beyond the fixed size. Builds without -fcallgraph-info=su
+    # (uVision, IAR) keep the fixed size. A record setting stack_size
+    # overrides both.
+    stack_size = layout.get('stack_size')
+    if stack_size is None:
+        stack_size = STACK_SIZE
+        graph = stack_usage.load_call_graph(
+            args.stack_usage or os.path.dirname(os.path.abspath(args.elf_path)))
+        if graph is not None:
+            entries = [name for name, value in algo.symbols.items() if value != 0xFFFFFFFF]
+            stack_size = max(stack_size, stack_usage.stack_size(graph, entries))
+    print("Stack size: 0x%x" % stack_size)
+
+    if stack_start is None:
+        # Allocate stack after algo and its rw and zi data, rounded up.
+        SP = blob_start + blob_size + stack_size
+        SP = (SP + 0x100 - 1) // 0x100 * 0x100
+    else:
+        SP = (stack_start + stack_size) // 8 * 8
+    regions = [("blob", blob_start, blob_size), ("stack", SP - stack_size, stack_size)]
+
+    # Double buffered pages. DAPLink only uses the first buffer.
+    if buffer_start is None:
+        data_buffer = blob_start + 0x00000A00
+        page_buffer = blob_start + 0x1000
+        # DAPLink uses data_buffer and pyOCD the page_buffers, so the two
+        # may overlap each other but not the blob or the stack.
+        check_overlap(regions + [("data buffer", data_buffer, algo.page_size)])
+        check_overlap(regions + [("page buffers", page_buffer, 2 * algo.page_size)])
+    else:
+        data_buffer = page_buffer = buffer_start
+        regions.append(("buffers", buffer_start, 2 * algo.page_size))
+        check_overlap(regions)
+
+    # Bytes up to the next word boundary after RW are zero padding in the
+    # blob, so only whole words need to be cleared by the stub.
+    zi_start = (algo.zi_start + 3) // 4 * 4
+    zi_end = max(zi_start, (algo.zi_start + algo.zi_size + 3) // 4 * 4)
+    zi_init_data = '0x00000001, 0x%08X, 0x%08X, 0x%08X,' % (
+        HEADER_SIZE + zi_start - ZI_INIT_FLAG,
+        zi_end - zi_start,
+        HEADER_SIZE + algo.symbols['Init'] - ZI_INIT_FLAG + 1)
+
+    # Build ID identifies the elf the blob came from, 0 is reserved for
+    # "not resident".
+    build_id = (zlib.crc32(elf_data) & 0xFFFFFFFF) or 1
+    ro_crc = crc32_msb(algo.algo_data[algo.ro_start:algo.ro_start + algo.ro_size])
+    identify_data = '0x%08X, 0x%08X, 0x%08X, 0x%08X, 0x%08X,' % (
+        HEADER_SIZE + algo.ro_start - IDENTIFY_DATA,
+        algo.ro_size,
+        CRC_POLY,
+        ro_crc,
+        build_id)
 
     data_dict = {
         'name': os.path.splitext(os.path.split(args.elf_path)[-1])[0],
-        'prog_header': BLOB_HEADER,
+        'prog_header': '\n    '.join([BLOB_HEADER, ZI_INIT_STUB, zi_init_data,
+                                       IDENTIFY_STUB, identify_data]),
         'header_size': HEADER_SIZE,
-        'entry': args.blob_start,
+        'zi_init': ZI_INIT_OFFSET,
+        'identify': IDENTIFY_OFFSET,
+        'build_id': build_id,
+        'entry': blob_start,
         'stack_pointer': SP,
+        'data_buffer': data_buffer,
+        'page_buffer': page_buffer,
     }
 
     tmpl_name_list = [
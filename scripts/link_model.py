@@ -0,0 +1,159 @@
+'''
+FlashAlgo
+Copyright (c) 2011-2017 ARM Limited
+
+Licensed under the Apache License, Version 2.0 (the 'License');
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an 'AS IS' BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Debug link cost of programming through a flash algo. The blob metadata
+generated from py_blob.tmpl gives the blob size, page size and sectors;
+this prices the probe session around it: loading the blob, the register
+writes, resume and halt polling of every algo call, and moving the page
+data, as CMSIS-DAP packets over USB and transfers on SWD. Changes to the
+page size, blob size or how many calls a region takes can then be judged
+by end to end programming time without a probe attached.
+
+The cost of the algo itself on the target is not part of this model, pass
+the times from timing_model.py or the datasheet with --page_us and
+--sector_us.
+'''
+import argparse
+import math
+
+# SWD packet: request, turnaround, ack, turnaround and 32 data + parity
+SWD_REQUEST_BITS = 8
+SWD_ACK_BITS = 3
+SWD_DATA_BITS = 33
+
+# DAP_Transfer: command, DAP index and count then 1 request byte per
+# transfer, plus 4 data bytes per write. DAP_TransferBlock: command, DAP
+# index, 2 byte count and request, then 4 data bytes per word.
+DAP_TRANSFER_HEADER = 3
+DAP_BLOCK_HEADER = 5
+
+# Registers set for each call: R0-R3, R9 (static base), SP, LR and PC
+CALL_REGISTERS = 8
+
+# TAR auto increment is only guaranteed within 1KB
+TAR_WRAP = 0x400
+
+
+class LinkModel(object):
+    """Time of CMSIS-DAP commands over USB and SWD, in microseconds"""
+
+    def __init__(self, swd_hz=4000000, round_trip_us=1000, packet_size=64,
+                 turnaround=1, idle_cycles=0):
+        self.swd_hz = swd_hz
+        self.round_trip_us = round_trip_us
+        self.packet_size = packet_size
+        self.transfer_bits = (SWD_REQUEST_BITS + SWD_ACK_BITS + SWD_DATA_BITS +
+                              2 * turnaround + idle_cycles)
+
+    def _swd_us(self, transfers):
+        return transfers * self.transfer_bits * 1e6 / self.swd_hz
+
+    def transfers(self, writes, reads):
+        """Time of DAP_Transfer commands for single AP/DP accesses"""
+        space = self.packet_size - DAP_TRANSFER_HEADER
+        packets = max(1, int(math.ceil((writes * 5.0 + reads) / space)))
+        return packets * self.round_trip_us + self._swd_us(writes + reads)
+
+    def write_block(self, size):
+        """Time of writing memory with DAP_TransferBlock"""
+        words = (size + 3) // 4
+        per_packet = (self.packet_size - DAP_BLOCK_HEADER) // 4
+        packets = int(math.ceil(float(words) / per_packet))
+        setups = int(math.ceil(float(size) / TAR_WRAP))
+        return (packets * self.round_trip_us + self._swd_us(words) +
+                setups * self.transfers(2, 0))
+
+    def call(self, target_us=0):
+        """Time of one algo call: set registers, resume, poll and read R0"""
+        # DCRDR and DCRSR writes plus a DHCSR S_REGRDY read per register
+        setup = self.transfers(2 * CALL_REGISTERS, CALL_REGISTERS)
+        resume = self.transfers(1, 0)
+        polls = max(1, int(math.ceil(target_us / self.round_trip_us)))
+        wait = polls * self.transfers(0, 1)
+        result = self.transfers(1, 2)
+        return setup + resume + wait + result
+
+
+def load_blob(path):
+    """Return the flash_algo dict of a generated py_blob.py"""
+    scope = {}
+    with open(path) as file_handle:
+        exec(file_handle.read(), scope)
+    return scope['flash_algo']
+
+
+def session(link, algo, image_size, page_size=None, page_us=0, sector_us=0):
+    """Time of each step of programming image_size bytes from flash_start"""
+    page_size = page_size or algo['page_size']
+    # 'instructions' is a hex string, two characters per byte
+    blob_size = len(algo['instructions']) // 2
+    sectors = sorted(algo['sector_sizes'])
+    start = algo['flash_start']
+
+    erase = 0
+    adr = start
+    while adr < start + image_size:
+        size = [size for base, size in sectors if base <= adr - start][-1]
+        erase += link.call(sector_us)
+        adr += size
+
+    pages = int(math.ceil(float(image_size) / page_size))
+    program = pages * (link.write_block(page_size) + link.call(page_us))
+
+    return [
+        ("load blob", link.write_block(blob_size)),
+        ("init", link.call()),
+        ("erase", erase),
+        ("program", program),
+        ("uninit", link.call()),
+    ]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Debug link time estimate')
+    parser.add_argument("blob", help="py_blob.py generated for the algo")
+    parser.add_argument("--size", default=None, type=lambda v: int(v, 0),
+                        help="Image size, defaults to the whole flash")
+    parser.add_argument("--page_size", default=None, type=lambda v: int(v, 0),
+                        help="Bytes per ProgramPage call, defaults to szPage")
+    parser.add_argument("--page_us", default=0, type=float,
+                        help="Time of one ProgramPage on the target")
+    parser.add_argument("--sector_us", default=0, type=float,
+                        help="Time of one EraseSector on the target")
+    parser.add_argument("--swd_hz", default=4000000, type=int,
+                        help="SWD clock")
+    parser.add_argument("--round_trip_us", default=1000, type=float,
+                        help="USB command/response latency, 1000 for HID, "
+                        "about 125 for high speed bulk")
+    parser.add_argument("--packet_size", default=64, type=int,
+                        help="DAP packet size")
+    args = parser.parse_args()
+
+    algo = load_blob(args.blob)
+    link = LinkModel(args.swd_hz, args.round_trip_us, args.packet_size)
+    size = args.size or algo['flash_size']
+    total = 0
+    for step, usecs in session(link, algo, size, args.page_size,
+                               args.page_us, args.sector_us):
+        print("%-16s %10.1f ms" % (step, usecs / 1000))
+        total += usecs
+    print("%-16s %10.1f ms, %.1f KB/s" % ("total", total / 1000,
+                                          size / 1.024 / total * 1000))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,66 @@
+'''
+FlashAlgo
+Copyright (c) 2011-2017 ARM Limited
+
+Licensed under the Apache License, Version 2.0 (the 'License');
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an 'AS IS' BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Access to the target records from the host scripts. Besides the progen
+keys, a record can carry top-level entries used only by these scripts,
+such as ram_layout (generate_blobs.py) or timing (timing_model.py). The
+entries of all records of a project are merged in order.
+'''
+import os
+import yaml
+
+PROJECTS_YAML = os.path.join(os.path.dirname(os.path.realpath(__file__)),
+                             os.pardir, "projects.yaml")
+
+
+def _flatten(items):
+    for item in items:
+        if isinstance(item, list):
+            for sub in _flatten(item):
+                yield sub
+        else:
+            yield item
+
+
+def project_records(project):
+    """Return the parsed records of a project, in projects.yaml order"""
+    if not os.path.isfile(PROJECTS_YAML):
+        return []
+    root = os.path.dirname(PROJECTS_YAML)
+    with open(PROJECTS_YAML) as file_handle:
+        projects = yaml.safe_load(file_handle).get('projects', {})
+    records = []
+    for record in _flatten(projects.get(project, [])):
+        with open(os.path.join(root, record)) as file_handle:
+            records.append(yaml.safe_load(file_handle) or {})
+    return records
+
+
+def load_entry(project, key):
+    """Merge the top-level key entries of a project's records"""
+    entry = {}
+    for record in project_records(project):
+        entry.update(record.get(key) or {})
+    return entry
+
+
+def project_target(project):
+    """Return the core of a project, for example cortex-m0"""
+    target = None
+    for record in project_records(project):
+        target = (record.get('common') or {}).get('target', [target])[0]
+    return target
@@ -0,0 +1,148 @@
+'''
+FlashAlgo
+Copyright (c) 2011-2017 ARM Limited
+
+Licensed under the Apache License, Version 2.0 (the 'License');
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an 'AS IS' BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Worst case stack depth of the algo entry points, from the call graph
+files GCC writes with -fcallgraph-info=su (one .ci file per object, with
+the frame size of each function as -fstack-usage reports it).
+
+Functions without a frame size, such as libgcc, newlib or prebuilt
+library code, are charged a fixed allowance. Indirect calls, including
+calls into ROM through a function pointer, are charged the deepest
+function of the graph that makes no indirect call itself, and at least
+the same allowance. Recursion and unbounded dynamic frames are errors.
+'''
+import os
+import re
+import argparse
+
+# Library code and ROM routines without call graph information
+EXTERNAL_STACK = 0x40
+# Exception frame and handler on top of the deepest call
+STACK_MARGIN = 0x40
+
+INDIRECT_CALL = "__indirect_call"
+
+_NODE = re.compile(r'node: \{ title: "([^"]*)" label: "([^"]*)"')
+_EDGE = re.compile(r'edge: \{ sourcename: "([^"]*)" targetname: "([^"]*)"')
+_FRAME = re.compile(r'\\n(\d+) bytes \(([^)]*)\)')
+
+
+class _IndirectCall(Exception):
+    pass
+
+
+class CallGraph(object):
+    """Frame sizes and callees of the functions of a build"""
+
+    def __init__(self):
+        self.frames = {}
+        self.calls = {}
+
+    def parse(self, text):
+        """Add the nodes and edges of one .ci file"""
+        for title, label in _NODE.findall(text):
+            self.calls.setdefault(title, set())
+            match = _FRAME.search(label)
+            if match is None:
+                continue
+            if "dynamic" in match.group(2) and "bounded" not in match.group(2):
+                raise Exception("Stack usage: %s has an unbounded dynamic frame" % title)
+            self.frames[title] = max(self.frames.get(title, 0), int(match.group(1)))
+        for source, target in _EDGE.findall(text):
+            self.calls.setdefault(source, set()).add(target)
+
+    def _walk(self, name, indirect, memo, path):
+        if name in memo:
+            return memo[name]
+        if name == INDIRECT_CALL:
+            if indirect is None:
+                raise _IndirectCall()
+            return indirect, [name]
+        if name not in self.frames:
+            return EXTERNAL_STACK, [name]
+        if name in path:
+            raise Exception("Stack usage: recursion through %s" %
+                            " -> ".join(path[path.index(name):] + [name]))
+        depth, chain = 0, []
+        for callee in sorted(self.calls.get(name, ())):
+            sub_depth, sub_chain = self._walk(callee, indirect, memo, path + [name])
+            if sub_depth > depth:
+                depth, chain = sub_depth, sub_chain
+        memo[name] = (self.frames[name] + depth, [name] + chain)
+        return memo[name]
+
+    def indirect_stack(self):
+        """Allowance for an indirect call"""
+        worst = EXTERNAL_STACK
+        memo = {}
+        for name in self.frames:
+            try:
+                worst = max(worst, self._walk(name, None, memo, [])[0])
+            except Exception:
+                # Makes indirect calls or recurses, only an error if reached
+                # from an entry point
+                pass
+        return worst
+
+    def worst_case(self, entries):
+        """Return {entry: (bytes, call chain)} for the entries in the graph"""
+        indirect = self.indirect_stack()
+        memo = {}
+        result = {}
+        for entry in entries:
+            if entry in self.frames:
+                result[entry] = self._walk(entry, indirect, memo, [])
+        return result
+
+
+def load_call_graph(path):
+    """Parse the .ci files below path, None if there are none"""
+    graph = CallGraph()
+    found = False
+    for root, _, files in os.walk(path):
+        for name in sorted(files):
+            if name.endswith(".ci"):
+                with open(os.path.join(root, name)) as file_handle:
+                    graph.parse(file_handle.read())
+                found = True
+    return graph if found else None
+
+
+def stack_size(graph, entries):
+    """Stack size for the deepest entry point, a multiple of 8 bytes"""
+    depth = max([d for d, _ in graph.worst_case(entries).values()] or [0])
+    return (depth + STACK_MARGIN + 7) // 8 * 8
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Worst case stack depth of an algo")
+    parser.add_argument("path", help="Build directory holding the .ci files")
+    parser.add_argument("entries", nargs="*", default=["Init", "UnInit", "EraseChip",
+                        "EraseSector", "ProgramPage", "Verify", "BlankCheck"],
+                        help="Entry points to report")
+    args = parser.parse_args()
+
+    graph = load_call_graph(args.path)
+    if graph is None:
+        raise Exception("No .ci files in %s, build with -fcallgraph-info=su" % args.path)
+    for entry, (depth, chain) in sorted(graph.worst_case(args.entries).items()):
+        print("%-16s %5d  %s" % (entry, depth, " -> ".join(chain)))
+    print("stack size       %5d" % stack_size(graph, args.entries))
+
+
+if __name__ == '__main__':
+    main()
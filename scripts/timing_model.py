@@ -0,0 +1,156 @@
+'''
+FlashAlgo
+Copyright (c) 2011-2017 ARM Limited
+
+Licensed under the Apache License, Version 2.0 (the 'License');
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an 'AS IS' BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Cycle-approximate cost model for running a flash algo. It prices an
+instruction trace, as produced by an emulator or a core trace of a real
+run, with the wait states of the memory each fetch and data access goes
+to, the stall when fetch and data share a bus, and the latency of the
+peripherals the algo talks to. Comparing the cycles of two builds of a
+ProgramPage or Verify inner loop is then closer to the target than
+comparing instruction counts.
+
+The model comes from the timing entry of the project's records:
+
+    timing:
+        # FLASHCFG FLASHTIM is cleared by Init, 1 cycle flash access
+        contention: 1
+        regions:
+            - {name: flash, start: 0x00000000, size: 0x80000, wait_states: 0}
+            - {name: sramx, start: 0x04000000, size: 0x8000, wait_states: 0}
+        mmio:
+            - {name: fmc, start: 0x40034000, size: 0x1000, latency: 2}
+
+A region can name its bus. By default accesses below 0x20000000 use the
+Cortex-M3/M4 I-code and D-code buses, which run in parallel, and the rest
+use the system bus. Cortex-M0 and M0+ only have one bus.
+
+A trace has one instruction per line, hex numbers, # starts a comment:
+
+    <pc> <cycles> [r:<address>] [w:<address>] ...
+
+where cycles is the core cost of the instruction with zero wait states.
+'''
+import argparse
+import records
+
+# Cores with a single AHB-Lite master for fetch and data
+VON_NEUMANN_CORES = ('cortex-m0', 'cortex-m0+', 'cortex-m1')
+
+
+class Region(object):
+    """A block of the memory map and its access cost"""
+
+    def __init__(self, entry, cost_key):
+        self.name = entry['name']
+        self.start = entry['start']
+        self.size = entry['size']
+        self.cost = entry.get(cost_key, 0)
+        self.bus = entry.get('bus')
+
+    def __contains__(self, addr):
+        return self.start <= addr < self.start + self.size
+
+
+class TimingModel(object):
+    """Cycle cost of instruction fetches and data accesses"""
+
+    def __init__(self, timing, target=None):
+        self.regions = [Region(entry, 'wait_states')
+                        for entry in timing.get('regions', [])]
+        self.mmio = [Region(entry, 'latency')
+                     for entry in timing.get('mmio', [])]
+        self.contention = timing.get('contention', 1)
+        self.single_bus = target in VON_NEUMANN_CORES
+        self.cycles = {}
+
+    @staticmethod
+    def from_project(project):
+        """Create the model of a project from its records"""
+        timing = records.load_entry(project, 'timing')
+        if not timing:
+            raise Exception("No timing entry in the records of %s" % project)
+        return TimingModel(timing, records.project_target(project))
+
+    def _find(self, addr):
+        for region in self.mmio + self.regions:
+            if addr in region:
+                return region
+        return None
+
+    def _bus(self, addr, fetch):
+        region = self._find(addr)
+        if self.single_bus:
+            return 'ahb'
+        if region is not None and region.bus is not None:
+            return region.bus
+        if addr < 0x20000000:
+            return 'icode' if fetch else 'dcode'
+        return 'system'
+
+    def _charge(self, addr, cycles):
+        region = self._find(addr)
+        name = region.name if region is not None else 'unmapped'
+        self.cycles[name] = self.cycles.get(name, 0) + cycles
+        return cycles
+
+    def instruction(self, pc, cycles, accesses=()):
+        """Cycles of one instruction
+
+        @param pc address the instruction is fetched from
+        @param cycles core cost with zero wait states
+        @param accesses (kind, address) data accesses, kind is r or w
+        """
+        region = self._find(pc)
+        total = self._charge(pc, cycles + (region.cost if region else 0))
+        fetch_bus = self._bus(pc, True)
+        for _, addr in accesses:
+            region = self._find(addr)
+            extra = region.cost if region else 0
+            if self._bus(addr, False) == fetch_bus:
+                extra += self.contention
+            total += self._charge(addr, extra)
+        return total
+
+    def run(self, trace):
+        """Total cycles of an iterable of trace lines"""
+        total = 0
+        for line in trace:
+            fields = line.split('#')[0].split()
+            if not fields:
+                continue
+            accesses = [(field[0], int(field[2:], 16)) for field in fields[2:]]
+            total += self.instruction(int(fields[0], 16), int(fields[1], 16),
+                                      accesses)
+        return total
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Flash algo cycle estimate')
+    parser.add_argument("project", help="Project name from projects.yaml")
+    parser.add_argument("trace", help="Instruction trace of the algo call")
+    args = parser.parse_args()
+
+    model = TimingModel.from_project(args.project)
+    with open(args.trace) as file_handle:
+        total = model.run(file_handle)
+    for name in sorted(model.cycles):
+        print("%-16s %d" % (name, model.cycles[name]))
+    print("%-16s %d" % ("total", total))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,188 @@
+'''
+FlashAlgo
+Copyright (c) 2011-2017 ARM Limited
+
+Licensed under the Apache License, Version 2.0 (the 'License');
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an 'AS IS' BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Benchmark workloads for the flash algos. For the flash region of an algo,
+as described by its FlashDevice and carried into the generated
+py_blob.py, this writes a fixed set of Intel HEX images:
+
+    dense       the whole region filled with data
+    sparse      a few code sized segments separated by large 0xFF gaps
+    delta_base  an image and a small update of it, a few short edits
+    delta
+    unaligned   segments that start and end away from page boundaries
+    straddle    segments across every change of sector size, for example
+                the 16KB to 64KB step of STM32F4, and across the first
+                sector boundary otherwise
+
+The data comes from a fixed xorshift generator seeded by the region and
+workload names, so every run on every host produces the same images and
+throughput numbers of different targets and builds can be compared. A
+workloads.yaml next to the images lists their segments.
+'''
+import argparse
+import os
+import zlib
+import yaml
+from link_model import load_blob
+
+# Largest part of a region used, keeps QSPI images to a sensible size
+DEFAULT_LIMIT = 0x100000
+
+WORKLOADS = ('dense', 'sparse', 'delta_base', 'delta', 'unaligned', 'straddle')
+
+
+class XorShift(object):
+    """32 bit xorshift, identical output on Python 2 and 3"""
+
+    def __init__(self, seed):
+        self.state = (seed & 0xFFFFFFFF) or 1
+
+    def next(self):
+        x = self.state
+        x ^= (x << 13) & 0xFFFFFFFF
+        x ^= x >> 17
+        x ^= (x << 5) & 0xFFFFFFFF
+        self.state = x
+        return x
+
+    def below(self, limit):
+        return self.next() % limit
+
+    def data(self, size):
+        out = bytearray()
+        while len(out) < size:
+            word = self.next()
+            out += bytearray([word & 0xFF, (word >> 8) & 0xFF,
+                              (word >> 16) & 0xFF, word >> 24])
+        return out[:size]
+
+
+def sector_boundaries(algo, size):
+    """Return (address, size) of each sector start below size"""
+    sectors = sorted(algo['sector_sizes'])
+    sectors = [(base, sz) for base, sz in sectors if base < size]
+    out = []
+    for i, (base, sz) in enumerate(sectors):
+        end = sectors[i + 1][0] if i + 1 < len(sectors) else size
+        out += [(adr, sz) for adr in range(base, min(end, size), sz)]
+    return out
+
+
+def make_segments(name, algo, size):
+    """Return {workload: [(offset, data), ...]} for a region"""
+    page = algo['page_size']
+    gen = lambda workload: XorShift(zlib.crc32((name + workload).encode()))
+    images = {}
+
+    rng = gen('dense')
+    images['dense'] = [(0, rng.data(size))]
+
+    rng = gen('sparse')
+    count = 4
+    images['sparse'] = []
+    for i in range(count):
+        length = min(size // (count * 4), 0x800 + rng.below(0x2000))
+        images['sparse'].append((i * size // count, rng.data(length)))
+
+    rng = gen('delta')
+    base = images['dense'][0][1][:min(size, 0x10000)]
+    images['delta_base'] = [(0, base)]
+    delta = bytearray(base)
+    for _ in range(8):
+        length = 1 + rng.below(64)
+        adr = rng.below(len(delta) - length)
+        delta[adr:adr + length] = rng.data(length)
+    images['delta'] = [(0, delta)]
+
+    rng = gen('unaligned')
+    images['unaligned'] = []
+    adr = 1 + rng.below(page - 1) if page > 1 else 0
+    while adr + 3 * page < size and len(images['unaligned']) < 8:
+        length = page + 1 + rng.below(2 * page)
+        images['unaligned'].append((adr, rng.data(length)))
+        adr += length + 1 + rng.below(page)
+
+    rng = gen('straddle')
+    sectors = sector_boundaries(algo, size)
+    steps = [adr for (adr, sz), (_, prev) in zip(sectors[1:], sectors) if sz != prev]
+    if not steps and len(sectors) > 1:
+        steps = [sectors[1][0]]
+    images['straddle'] = []
+    for adr in steps:
+        before = min(adr, page + rng.below(page))
+        after = min(size - adr, page + rng.below(page))
+        images['straddle'].append((adr - before, rng.data(before + after)))
+    return images
+
+
+def write_ihex(path, start, segments):
+    """Write the segments as Intel HEX with extended linear addresses"""
+    def record(rtype, adr, data):
+        rec = bytearray([len(data), (adr >> 8) & 0xFF, adr & 0xFF, rtype]) + data
+        return ":%s%02X\n" % ("".join("%02X" % b for b in rec), -sum(rec) & 0xFF)
+
+    lines = []
+    upper = None
+    for offset, data in segments:
+        for pos in range(0, len(data), 16):
+            adr = start + offset + pos
+            chunk = data[pos:min(pos + 16, len(data), 0x10000 - (adr & 0xFFFF) + pos)]
+            if adr >> 16 != upper:
+                upper = adr >> 16
+                lines.append(record(4, 0, bytearray([upper >> 8, upper & 0xFF])))
+            lines.append(record(0, adr & 0xFFFF, chunk))
+            rest = data[pos + len(chunk):pos + 16]
+            if rest:
+                upper = (adr + len(chunk)) >> 16
+                lines.append(record(4, 0, bytearray([upper >> 8, upper & 0xFF])))
+                lines.append(record(0, 0, rest))
+    lines.append(record(1, 0, bytearray()))
+    with open(path, "w") as file_handle:
+        file_handle.write("".join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Benchmark workload images')
+    parser.add_argument("blobs", nargs='+', help="py_blob.py of each algo, "
+                        "named after the directory it is in")
+    parser.add_argument("--output", default="workloads", help="Output directory")
+    parser.add_argument("--limit", default=DEFAULT_LIMIT, type=lambda v: int(v, 0),
+                        help="Largest part of a region to use")
+    args = parser.parse_args()
+
+    manifest = {}
+    for path in args.blobs:
+        algo = load_blob(path)
+        name = os.path.basename(os.path.dirname(os.path.abspath(path)))
+        size = min(algo['flash_size'], args.limit)
+        start = algo['flash_start']
+        out_dir = os.path.join(args.output, name)
+        if not os.path.isdir(out_dir):
+            os.makedirs(out_dir)
+        images = make_segments(name, algo, size)
+        manifest[name] = {}
+        for workload in WORKLOADS:
+            segments = images[workload]
+            write_ihex(os.path.join(out_dir, workload + ".hex"), start, segments)
+            manifest[name][workload] = [[start + offset, len(data)]
+                                        for offset, data in segments]
+    with open(os.path.join(args.output, "workloads.yaml"), "w") as file_handle:
+        yaml.safe_dump(manifest, file_handle, default_flow_style=None)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,72 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file FlashChunk.h */
+
+#ifndef FLASHCHUNK_H
+#define FLASHCHUNK_H
+
+#include "stdint.h"
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+/* Programming a range through ProgramPage one chunk at a time, used by
+ * ProgramFill and CopyFlash. Chunks do not cross a FLASH_CHUNK_SIZE
+ * boundary. Some algos always program a whole page, so the rest of a
+ * partial chunk is padded with the erased value.
+ *
+ * Usage:
+ *   buf = FlashChunk_Buffer();
+ *   while (sz > 0) {
+ *       len = FlashChunk_Size(adr, sz);
+ *       // fill len bytes of buf
+ *       FlashChunk_Program(adr, len);
+ *       adr += len;
+ *       sz -= len;
+ *   }
+ */
+
+// Must not exceed the programming page size
+#ifndef FLASH_CHUNK_SIZE
+#define FLASH_CHUNK_SIZE    256
+#endif
+
+/** Buffer for one chunk, word aligned
+    @return start of the buffer
+ */
+uint8_t *FlashChunk_Buffer(void);
+
+/** Size of the chunk starting at an address
+    @param adr address to program
+    @param sz the amount of data left to program
+    @return chunk size in bytes, at most sz
+ */
+uint32_t FlashChunk_Size(uint32_t adr, uint32_t sz);
+
+/** Pad the buffer after len bytes and program it
+    @param adr address to program, the start of a chunk
+    @param len the amount of data in the buffer
+    @return 0 on success, an error code otherwise
+ */
+uint32_t FlashChunk_Program(uint32_t adr, uint32_t len);
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif
@@ -0,0 +1,66 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file FlashJournal.h */
+
+#ifndef FLASHJOURNAL_H
+#define FLASHJOURNAL_H
+
+#include "stdint.h"
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+/* Progress journal kept in algo RAM so that a host can resume a programming
+ * session after losing the probe connection. The journal is exported as the
+ * FlashJournal symbol, its address is listed in the generated blobs.
+ *
+ * Resume protocol:
+ *  1. Call Identify, the algo must still be resident (see generate_blobs.py)
+ *  2. Read the journal before calling Init, it is only valid if magic matches
+ *  3. Skip sectors up to and including erased, pages ending at or before
+ *     programmed, then continue the session as usual
+ *  4. Write 0 to magic before starting a new, unrelated session
+ */
+
+#define FLASH_JOURNAL_MAGIC 0x4C4E524A  // "JRNL"
+#define FLASH_JOURNAL_NONE  0xFFFFFFFF  // Nothing recorded yet
+#define FLASH_JOURNAL_CHIP  0xFFFFFFFE  // Whole device erased
+
+typedef struct {
+    uint32_t magic;         // FLASH_JOURNAL_MAGIC once anything is recorded
+    uint32_t erased;        // Address of the last erased sector
+    uint32_t programmed;    // End address of the last programmed page
+    uint32_t count;         // Incremented after every record
+} flash_journal_t;
+
+/** Record a successfully erased sector
+    @param adr address of the sector, or FLASH_JOURNAL_CHIP
+ */
+void FlashJournal_Erased(uint32_t adr);
+
+/** Record a successfully programmed (and verified, if the algo does) page
+    @param adr address of the page
+    @param sz the amount of data programmed
+ */
+void FlashJournal_Programmed(uint32_t adr, uint32_t sz);
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif
@@ -20,11 +20,28 @@
 #define FLASHPRG_H
 
 #include "stdint.h"
+#include "FlashOS.h"
 
 #ifdef __cplusplus
   extern "C" {
 #endif
 
+// Device description from FlashDev.c, which every algo links. Declared
+// hidden so that GCC reaches it PC relative instead of through the GOT.
+#ifdef __GNUC__
+extern const struct FlashDevice FlashDevice __attribute__((visibility("hidden")));
+#else
+extern const struct FlashDevice FlashDevice;
+#endif
+
+// Value of an erased byte, as the host reads it from FlashDevice
+#define FLASH_ERASED_BYTE   (FlashDevice.valEmpty)
+
+// Sector states reported by SurveySectors
+#define SECTOR_BLANK    0   // Erased
+#define SECTOR_PARTIAL  1   // Both erased and programmed words
+#define SECTOR_FULL     2   // No erased words
+
 /** Initialize programming functions
     @param adr device base address
     @param clk clock frequency (Hz)
@@ -74,6 +91,90 @@ uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf);
  */
 uint32_t Verify(uint32_t adr, uint32_t sz, uint32_t *buf);
 
+/** Hash memory contents block by block [optional]
+    For each block two words are stored: the rsync style weak checksum
+    (a | b << 16) followed by the CRC-32 (as zlib.crc32) of the block.
+    The last block may be shorter than blk.
+    @param adr start address of the first block
+    @param sz the amount of memory to hash
+    @param blk block size in bytes
+    @param out buffer for 2 words per block
+    @return 0 on success, an error code otherwise
+ */
+uint32_t HashBlocks(uint32_t adr, uint32_t sz, uint32_t blk, uint32_t *out);
+
+/** Program a repeated pattern into memory [optional]
+    The range is programmed through ProgramPage, one chunk at a time.
+    @param adr word aligned address to start programming from
+    @param sz the amount of memory to program, a multiple of 4
+    @param pattern word to repeat over the range
+    @return 0 on success, an error code otherwise
+ */
+uint32_t ProgramFill(uint32_t adr, uint32_t sz, uint32_t pattern);
+
+/** Copy memory contents to another, erased, location [optional]
+    Source and destination may be on different devices handled by the
+    same algo but must not overlap.
+    @param src address to copy from
+    @param dst word aligned address to program
+    @param sz the amount of data to copy, a multiple of 4
+    @return 0 on success, an error code otherwise
+ */
+uint32_t CopyFlash(uint32_t src, uint32_t dst, uint32_t sz);
+
+/** Program data smaller than, or not aligned to, the program unit [optional]
+    Each unit covered is read back with ReadData, merged with the new data
+    and programmed whole. Units that do not change are skipped. Fails if
+    the data needs bits to return to the erased state.
+    @param adr address to start programming from
+    @param sz the amount of data to program
+    @param buf memory contents to be programmed
+    @return 0 on success, an error code otherwise
+ */
+uint32_t ProgramPartial(uint32_t adr, uint32_t sz, uint32_t *buf);
+
+/** Read memory contents, used by CopyFlash and ProgramPartial
+    A memory mapped version is provided by common/FlashRead.c, algos for
+    devices that are not memory mapped implement their own.
+    @param adr address to start reading from
+    @param sz the amount of data to read
+    @param buf buffer for the data
+    @return 0 on success, an error code otherwise
+ */
+uint32_t ReadData(uint32_t adr, uint32_t sz, uint8_t *buf);
+
+/** Classify every sector in a range [optional]
+    Two bits per sector hold one of the SECTOR_ states, sixteen sectors
+    per word starting from the least significant bits.
+    @param start address of the first sector
+    @param end address after the last sector
+    @param bitmap buffer for one word per sixteen sectors
+    @return 0 on success, an error code otherwise
+ */
+uint32_t SurveySectors(uint32_t start, uint32_t end, uint32_t *bitmap);
+
+/** Size of the sector containing an address, used by SurveySectors
+    Provided from FLASH_SECTOR_SIZE unless FLASH_SURVEY_CUSTOM is defined.
+    @param adr address of a sector
+    @return sector size in bytes
+ */
+uint32_t SectorSize(uint32_t adr);
+
+/** State of a single sector, used by SurveySectors
+    Provided by SectorScan unless FLASH_SURVEY_CUSTOM is defined.
+    @param adr address of a sector
+    @param sz size of the sector
+    @return one of the SECTOR_ states
+ */
+uint32_t SectorState(uint32_t adr, uint32_t sz);
+
+/** Classify a memory mapped sector by comparing words
+    @param adr address of a sector
+    @param sz size of the sector
+    @return one of the SECTOR_ states
+ */
+uint32_t SectorScan(uint32_t adr, uint32_t sz);
+
 #ifdef __cplusplus
   }
 #endif
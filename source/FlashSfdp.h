@@ -0,0 +1,89 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file FlashSfdp.h */
+
+#ifndef FLASHSFDP_H
+#define FLASHSFDP_H
+
+#include "stdint.h"
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+/* JEDEC JESD216 Serial Flash Discoverable Parameters, as used by the SPI-NOR
+ * algos at Init. The algo fills sfdp_info_t with the values it used to
+ * hardcode, then calls Sfdp_Parse which overwrites them with what the device
+ * reports. Devices without SFDP keep the hardcoded values.
+ */
+
+#define SFDP_READ_CMD       0x5A    // 3 byte address, 8 dummy cycles
+#define SFDP_READ_DUMMY     8
+#define SFDP_ERASE_TYPES    4
+
+// Quad enable requirements, BFPT DWORD 15 bits 22:20
+#define SFDP_QER_NONE       0       // No QE bit, quad mode always available
+#define SFDP_QER_SR2_BIT1   1       // QE is SR2 bit 1, written with 0x01 and 2 bytes
+#define SFDP_QER_SR1_BIT6   2       // QE is SR1 bit 6, written with 0x01
+#define SFDP_QER_SR2_BIT7   3       // QE is SR2 bit 7, written with 0x3E
+#define SFDP_QER_SR2_BIT1_A 4       // As SFDP_QER_SR2_BIT1
+#define SFDP_QER_SR2_BIT1_B 5       // As SFDP_QER_SR2_BIT1, SR2 read with 0x35
+#define SFDP_QER_SR2_BIT1_C 6       // QE is SR2 bit 1, written with 0x31
+
+// Enter 4 byte addressing methods, BFPT DWORD 16 bits 31:24
+#define SFDP_4B_ENTER_B7        0x01    // Issue 0xB7
+#define SFDP_4B_ENTER_WREN_B7   0x02    // Issue write enable, then 0xB7
+#define SFDP_4B_ALWAYS          0x40    // Always in 4 byte address mode
+
+typedef struct {
+    uint32_t density;                           // Device size in bytes
+    uint32_t page_size;                         // Program page size in bytes
+    uint32_t erase_size[SFDP_ERASE_TYPES];      // 0 if the erase type is unused
+    uint8_t  erase_opcode[SFDP_ERASE_TYPES];
+    uint8_t  addr_bytes;                        // 3 or 4
+    uint8_t  quad_enable;                       // One of SFDP_QER_*
+    uint8_t  enter_4byte;                       // BFPT DWORD 16 bits 31:24
+} sfdp_info_t;
+
+/** Read from the SFDP address space of the device
+    @param adr SFDP address
+    @param sz the amount of data to read
+    @param buf where to store the data
+    @return 0 on success, an error code otherwise
+ */
+typedef uint32_t (*sfdp_read_t)(uint32_t adr, uint32_t sz, uint8_t *buf);
+
+/** Parse the basic flash parameter table of the device
+    @param read SFDP read function of the algo
+    @param info parameters, left untouched if the device has no SFDP
+    @return 0 on success, 1 if the device has no usable SFDP
+ */
+uint32_t Sfdp_Parse(sfdp_read_t read, sfdp_info_t *info);
+
+/** Pick the largest erase type that tiles a sector
+    @param info parameters filled by Sfdp_Parse
+    @param sz the size of the sector
+    @param opcode where to store the erase opcode
+    @return the erase size, 0 if no erase type divides sz
+ */
+uint32_t Sfdp_EraseSize(const sfdp_info_t *info, uint32_t sz, uint8_t *opcode);
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif
@@ -0,0 +1,61 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file FlashSparse.h */
+
+#ifndef FLASHSPARSE_H
+#define FLASHSPARSE_H
+
+#include "stdint.h"
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+/* Sparse page programming for SPI-NOR algos. Programming an erased byte to
+ * 0xFF leaves it unchanged, so a ProgramPage only has to send the runs of
+ * data between the erased bytes. Runs are split where at least
+ * FLASH_SPARSE_GAP erased bytes follow each other, shorter gaps cost less
+ * than the extra write enable, command and status polling.
+ *
+ * Usage:
+ *   for (ofs = 0; (len = FlashSparse_NextRun(buf, sz, &ofs)) != 0; ofs += len) {
+ *       // program len bytes from buf + ofs at adr + ofs
+ *   }
+ */
+
+#ifndef FLASH_SPARSE_GAP
+#define FLASH_SPARSE_GAP    32
+#endif
+
+// Runs start and end on this boundary, for controllers fed with words
+#ifndef FLASH_SPARSE_ALIGN
+#define FLASH_SPARSE_ALIGN  4
+#endif
+
+/** Find the next run of data to program
+    @param buf page data
+    @param sz the size of the page
+    @param ofs offset to start looking at, set to the start of the run
+    @return the length of the run, 0 if the rest of the page is erased
+ */
+uint32_t FlashSparse_NextRun(const uint8_t *buf, uint32_t sz, uint32_t *ofs);
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif
@@ -0,0 +1,82 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file FlashTiming.h */
+
+#ifndef FLASHTIMING_H
+#define FLASHTIMING_H
+
+#include "stdint.h"
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+/* Measured durations of the most recent operations, kept in algo RAM so that
+ * a host can schedule its halt polls near the real completion time. The
+ * record is exported as the FlashTiming symbol, its address is listed in the
+ * generated blobs next to toProg and toErase from FlashDev.c. Algos that
+ * wait through FlashWait, or poll for long operations, list FlashTiming.c.
+ * Algos without FlashTiming.c do not define the FlashTiming symbol.
+ *
+ * Durations are in core cycles where the core has the DWT cycle counter.
+ * Elsewhere they count FlashWait_Idle pauses of unit loop iterations each,
+ * which the host calibrates once against a timed call. With FLASH_WAIT_IRQ
+ * the core sleeps instead of pausing, so on such cores nothing is measured
+ * and unit is FLASH_TIMING_NONE. unit is 0 until the first measurement.
+ *
+ * The cycle counter is enabled for the duration of an operation only, the
+ * debugger owned DEMCR.TRCENA and DWT_CTRL.CYCCNTENA are restored after it.
+ */
+
+#define FLASH_TIMING_SIZES  4           // Sector sizes tracked
+#define FLASH_TIMING_CYCLES 0xFFFFFFFE  // unit: durations are core cycles
+#define FLASH_TIMING_NONE   0xFFFFFFFF  // unit: nothing is measured
+#define FLASH_TIMING_CHIP   0xFFFFFFFF  // Size passed for a chip erase
+
+typedef struct {
+    uint32_t unit;                          // See above
+    uint32_t program;                       // Last ProgramPage
+    uint32_t program_size;                  // Size of the last ProgramPage
+    uint32_t chip;                          // Last EraseChip
+    uint32_t erase_size[FLASH_TIMING_SIZES];// Sector sizes seen, 0 if unused
+    uint32_t erase[FLASH_TIMING_SIZES];     // Last EraseSector of each size
+} flash_timing_t;
+
+/** Start measuring an operation
+ */
+void FlashTiming_Start(void);
+
+/** Stop measuring without recording, after a failed operation
+ */
+void FlashTiming_Stop(void);
+
+/** Record a successful erase and stop measuring
+    @param sz size of the sector, or FLASH_TIMING_CHIP
+ */
+void FlashTiming_Erased(uint32_t sz);
+
+/** Record a successfully programmed page and stop measuring
+    @param sz the amount of data programmed
+ */
+void FlashTiming_Programmed(uint32_t sz);
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif
@@ -0,0 +1,75 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file FlashWait.h */
+
+#ifndef FLASHWAIT_H
+#define FLASHWAIT_H
+
+#include "stdint.h"
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+/* Waiting for a flash operation to complete without hammering the bus.
+ *
+ * If the record defines FLASH_WAIT_IRQ, the core sleeps in WFE until the
+ * completion interrupt the driver passes to FlashWait_Start. The interrupt
+ * stays disabled in the NVIC for the duration of the wait and SEVONPEND
+ * turns it becoming pending into a wake up event, so no handler is needed.
+ * Otherwise every poll is followed by a pause of FLASH_WAIT_PACE loop
+ * iterations, which matters most on SPI devices where each poll is a whole
+ * status command.
+ *
+ * Usage:
+ *   start the operation, enable the controller interrupt if FLASH_WAIT_IRQ
+ *   FlashWait_Start(irq);
+ *   while (!done) {
+ *       FlashWait_Idle();
+ *   }
+ *   FlashWait_Stop();
+ *   disable the controller interrupt
+ */
+
+#ifndef FLASH_WAIT_PACE
+#define FLASH_WAIT_PACE 64
+#endif
+
+/** Prepare for waiting, the operation has already been started
+    @param irq completion interrupt of the controller, only used with
+        FLASH_WAIT_IRQ
+ */
+void FlashWait_Start(uint32_t irq);
+
+/** Sleep until the next event, or pause between polls
+ */
+void FlashWait_Idle(void);
+
+/** Restore the NVIC and SCB state changed by FlashWait_Start
+ */
+void FlashWait_Stop(void);
+
+/** Number of FlashWait_Idle calls so far, used by FlashTiming
+    @return the count, wraps around
+ */
+uint32_t FlashWait_Count(void);
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif
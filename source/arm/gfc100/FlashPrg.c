@@ -19,18 +19,18 @@
 
 #define  SYSTEM_CLOCK    (40960000UL)
 
-uint32_t initialized = 0;
+static uint32_t initialized = 0;
 
-struct gfc100_eflash_dev_cfg_t GFC100_DEV_CFG = {
+static struct gfc100_eflash_dev_cfg_t GFC100_DEV_CFG = {
     .base = MUSCA_B_EFLASH_REG_BASE,
 };
 
-struct gfc100_eflash_dev_data_t GFC100_DEV_DATA = {
+static struct gfc100_eflash_dev_data_t GFC100_DEV_DATA = {
     .is_initialized = false,
     .flash_size = 0x400000,
 };
 
-struct gfc100_eflash_dev_t GFC100_DEV;
+static struct gfc100_eflash_dev_t GFC100_DEV;
 
 /**
  * \brief Arm Flash device structure.
@@ -476,10 +476,23 @@ enum gfc100_error_t gfc100_eflash_row_write(struct gfc100_eflash_dev_t *dev,
 enum gfc100_error_t gfc100_eflash_erase(struct gfc100_eflash_dev_t *dev,
                                        uint32_t addr,
                                        enum gfc100_erase_type_t erase)
+{
+    enum gfc100_error_t err;
+
+    err = gfc100_eflash_erase_start(dev, addr, erase);
+    if (err != GFC100_ERROR_NONE) {
+        return err;
+    }
+
+    return gfc100_eflash_wait(dev);
+}
+
+enum gfc100_error_t gfc100_eflash_erase_start(struct gfc100_eflash_dev_t *dev,
+                                              uint32_t addr,
+                                              enum gfc100_erase_type_t erase)
 {
     struct gfc100_reg_map_t *reg_map =
                                      (struct gfc100_reg_map_t *)dev->cfg->base;
-    uint32_t status = 0U;
 
     if (dev->data->is_initialized == false) {
         return GFC100_ERROR_NOT_INITED;
@@ -499,29 +512,33 @@ enum gfc100_error_t gfc100_eflash_erase(struct gfc100_eflash_dev_t *dev,
             }
             reg_map->addr = addr;
             reg_map->ctrl = (CMD_ERASE << GFC100_CTRL_CMD_POS);
-            status = check_cmd_result(reg_map);
-            /* Clear IRQ status before issuing the next command */
-            clear_irq_status(reg_map);
             break;
         case GFC100_MASS_ERASE_MAIN_AREA:
             reg_map->addr = 0U;
             reg_map->ctrl = (CMD_MASS_ERASE << GFC100_CTRL_CMD_POS);
-            status = check_cmd_result(reg_map);
-            /* Clear IRQ status before issuing the next command */
-            clear_irq_status(reg_map);
             break;
         case GFC100_MASS_ERASE_ALL:
             reg_map->addr = GFC100_EXTENDED_AREA_OFFSET;
             reg_map->ctrl = (CMD_MASS_ERASE << GFC100_CTRL_CMD_POS);
-            status = check_cmd_result(reg_map);
-            /* Clear IRQ status before issuing the next command */
-            clear_irq_status(reg_map);
             break;
         default:
             return GFC100_ERROR_INVALID_PARAM;
     }
 
-    return ((status == GFC100_CMD_STAT_FAIL_MASK) ?
+    return GFC100_ERROR_NONE;
+}
+
+enum gfc100_error_t gfc100_eflash_wait(struct gfc100_eflash_dev_t *dev)
+{
+    struct gfc100_reg_map_t *reg_map =
+                                     (struct gfc100_reg_map_t *)dev->cfg->base;
+    uint32_t status;
+
+    status = check_cmd_result(reg_map);
+    /* Clear IRQ status before issuing the next command */
+    clear_irq_status(reg_map);
+
+    return ((status & GFC100_CMD_STAT_FAIL_MASK) ?
                        GFC100_ERROR_CMD_FAIL : GFC100_ERROR_NONE);
 }
 
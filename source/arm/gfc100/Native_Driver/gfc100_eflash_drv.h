@@ -160,6 +160,32 @@ enum gfc100_error_t gfc100_eflash_erase(struct gfc100_eflash_dev_t *dev,
                                        uint32_t addr,
                                        enum gfc100_erase_type_t erase);
 
+/**
+ * \brief Starts an erase of the flash without waiting for its completion
+ * \param[in] dev      GFC100 device struct \ref gfc100_eflash_dev_t
+ * \param[in] addr     Address of the page to erase
+ * \param[in] erase    Erase type \ref gfc100_erase_type_t
+ * \return Returns error code as specified in \ref gfc100_error_t
+ * \note The erase must be completed with \ref gfc100_eflash_wait before any
+ *       other command is issued to the controller. Other controllers can be
+ *       used in the meantime.
+ * \note For better performance, this function doesn't check if dev is NULL
+ * \note Addr is expected to be within the [0x0 - Flash size] range
+ * \note Addr is only used for page erase, and is automatically aligned
+ *       to page size.
+ */
+enum gfc100_error_t gfc100_eflash_erase_start(struct gfc100_eflash_dev_t *dev,
+                                              uint32_t addr,
+                                              enum gfc100_erase_type_t erase);
+
+/**
+ * \brief Waits for the command in progress to finish
+ * \param[in] dev      GFC100 device struct \ref gfc100_eflash_dev_t
+ * \return Returns error code as specified in \ref gfc100_error_t
+ * \note For better performance, this function doesn't check if dev is NULL
+ */
+enum gfc100_error_t gfc100_eflash_wait(struct gfc100_eflash_dev_t *dev);
+
 /**
  * \brief Checks if controller is locked
  *
@@ -23,7 +23,7 @@ struct FlashDevice const FlashDevice  =  {
    "MT25QL512",                // Device Name
    EXTSPI,                     // Device Type
    MUSCA_QSPI_FLASH_BASE,      // Device Start Address
-   0x00800000,                 // Device Size (8MB)
+   0x04000000,                 // Device Size (64MB)
    256,                        // Programming Page Size
    0,                          // Reserved, must be 0
    0xFF,                       // Initial Content of Erased Memory
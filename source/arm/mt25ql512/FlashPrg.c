@@ -15,8 +15,26 @@
  */
 
 #include "FlashOS.H"        // FlashOS Structures
+#include "FlashJournal.h"
+#include "FlashTiming.h"
+#include "FlashSfdp.h"
+#include "FlashSparse.h"
 #include "mt25ql_flash_lib.h"
 
+#define SECTOR_SIZE     0x10000     // See FlashDev.c
+
+#define QSPI_ADDR_MASK  0x0FFFFFFF  // Drops the secure alias bit, keeps 64MB
+
+/* With MUSCA_QSPI_DIRECT_WRITE pages are written through the AHB direct
+ * access window, the controller sends write enable and page program for
+ * the streamed words. STIG commands carry at most 8 bytes each.
+ */
+#ifdef MUSCA_QSPI_DIRECT_WRITE
+#define qspi_write  mt25ql_direct_write
+#else
+#define qspi_write  mt25ql_command_write
+#endif
+
 static const struct qspi_ip6514e_dev_cfg_t QSPI_DEV_CFG = {
     .base = MUSCA_QSPI_REG_BASE,
     /*
@@ -29,21 +47,21 @@ static const struct qspi_ip6514e_dev_cfg_t QSPI_DEV_CFG = {
     .addr_mask = (1U << 18) - 1, /* 256 KiB minus 1 byte */
 };
 
-uint32_t initialized = 0;
+static uint32_t initialized = 0;
 
 //struct qspi_ip6514e_dev_t QSPI_DEV = {
 //    &QSPI_DEV_CFG
 //};
-struct qspi_ip6514e_dev_t QSPI_DEV;
+static struct qspi_ip6514e_dev_t QSPI_DEV;
 
-struct mt25ql_dev_t MT25QL_DEV = {
+static struct mt25ql_dev_t MT25QL_DEV = {
 //    .controller = &QSPI_DEV,
     .direct_access_start_addr = MUSCA_QSPI_FLASH_BASE,
     .baud_rate_div = 4U,
     /*
      * 8 MiB flash memory are advertised in the Arm Musca-A Test Chip and Board
      * Technical Reference Manual. The MT25QL Flash device may however contain
-     * more.
+     * more, the SFDP density replaces this at Init.
      */
     .size = 0x00800000U, /* 8 MiB */
 };
@@ -60,6 +78,53 @@ struct arm_flash_dev_t {
 //};
 static struct arm_flash_dev_t ARM_FLASH0_DEV;
 
+/* Erase used for a sector, picked from the SFDP erase types at Init */
+static enum mt25ql_erase_t erase_type;
+static uint32_t erase_size;
+
+static uint32_t sfdp_read (uint32_t adr, uint32_t sz, uint8_t *buf) {
+    return qspi_ip6514e_send_read_cmd(ARM_FLASH0_DEV.dev->controller, SFDP_READ_CMD,
+                                      buf, sz, adr, 3, SFDP_READ_DUMMY);
+}
+
+/*
+ *  Match the device parameters against what mt25ql_flash_lib supports,
+ *  devices without SFDP keep the 64kB sector erase
+ */
+
+static void discover (void) {
+    sfdp_info_t info = {0};
+    uint8_t opcode = 0;
+
+    erase_type = MT25QL_ERASE_SECTOR_64K;
+    erase_size = SECTOR_SIZE;
+    if (Sfdp_Parse(sfdp_read, &info) != 0) {
+        return;
+    }
+    // Past 16 MiB the library switches to the 4 byte address opcodes
+    if (info.density != 0) {
+        ARM_FLASH0_DEV.dev->size = info.density;
+        ARM_FLASH0_DEV.dev->addr_bytes = info.density > 0x01000000 ? ADDR_BYTES_4B : ADDR_BYTES;
+    }
+    // Only use an erase type if its opcode is the one the library sends
+    switch (Sfdp_EraseSize(&info, SECTOR_SIZE, &opcode)) {
+        case 0x8000:
+            if (opcode == 0x52) {
+                erase_type = MT25QL_ERASE_SUBSECTOR_32K;
+                erase_size = 0x8000;
+            }
+            break;
+        case 0x1000:
+            if (opcode == 0x20) {
+                erase_type = MT25QL_ERASE_SUBSECTOR_4K;
+                erase_size = 0x1000;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
 /*
    Mandatory Flash Programming Functions (Called by FlashOS):
                 int Init        (unsigned long adr,   // Initialize Flash
@@ -101,9 +166,10 @@ int Init (unsigned long adr, unsigned long clk, unsigned long fnc) {
         ARM_FLASH0_DEV.dev = &MT25QL_DEV;
 
         qspi_ip6514e_enable(ARM_FLASH0_DEV.dev->controller);
+        discover();
 
         /* Configure QSPI Flash controller to operate in single SPI mode and
-         * to use fast Flash commands */
+         * to use fast Flash commands, with the address length found above */
         if (MT25QL_ERR_NONE != mt25ql_config_mode(ARM_FLASH0_DEV.dev, MT25QL_FUNC_STATE_FAST)) {
               return 1;
         }
@@ -137,9 +203,13 @@ int UnInit (unsigned long fnc) {
  */
 
 int EraseChip (void) {
+    FlashTiming_Start();
     if (MT25QL_ERR_NONE != mt25ql_erase(ARM_FLASH0_DEV.dev, 0, MT25QL_ERASE_ALL_FLASH)) {
+        FlashTiming_Stop();
         return 1;
     }
+    FlashTiming_Erased(FLASH_TIMING_CHIP);
+    FlashJournal_Erased(FLASH_JOURNAL_CHIP);
     return 0;
 }
 
@@ -151,10 +221,17 @@ int EraseChip (void) {
  */
 
 int EraseSector (unsigned long adr) {
-    adr = (adr & 0x00FFFFFF) - MUSCA_QSPI_FLASH_BASE;
-    if (MT25QL_ERR_NONE != mt25ql_erase(ARM_FLASH0_DEV.dev, adr, MT25QL_ERASE_SECTOR_64K)) {
-        return 1;
+    uint32_t offset = (adr & QSPI_ADDR_MASK) - MUSCA_QSPI_FLASH_BASE;
+    uint32_t i;
+    FlashTiming_Start();
+    for (i = 0; i < SECTOR_SIZE; i += erase_size) {
+        if (MT25QL_ERR_NONE != mt25ql_erase(ARM_FLASH0_DEV.dev, offset + i, erase_type)) {
+            FlashTiming_Stop();
+            return 1;
+        }
     }
+    FlashTiming_Erased(SECTOR_SIZE);
+    FlashJournal_Erased(adr);
     return 0;
 }
 
@@ -168,11 +245,24 @@ int EraseSector (unsigned long adr) {
  */
 
 int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf) {
-    adr = (adr & 0x00FFFFFF) - MUSCA_QSPI_FLASH_BASE;
-    enum mt25ql_error_t err = mt25ql_command_write(ARM_FLASH0_DEV.dev, adr, buf, sz);
-    if (MT25QL_ERR_NONE != err) {
-        return err;
+    uint32_t offset = (adr & QSPI_ADDR_MASK) - MUSCA_QSPI_FLASH_BASE;
+    uint32_t ofs, len;
+    enum mt25ql_error_t err;
+    /* Command writes would wrap around on a smaller device */
+    if (offset + sz > ARM_FLASH0_DEV.dev->size) {
+        return 1;
     }
+    FlashTiming_Start();
+    /* Erased bytes are skipped, see FlashSparse.h */
+    for (ofs = 0; (len = FlashSparse_NextRun(buf, sz, &ofs)) != 0; ofs += len) {
+        err = qspi_write(ARM_FLASH0_DEV.dev, offset + ofs, buf + ofs, len);
+        if (MT25QL_ERR_NONE != err) {
+            FlashTiming_Stop();
+            return err;
+        }
+    }
+    FlashTiming_Programmed(sz);
+    FlashJournal_Programmed(adr, sz);
     return 0;
 }
 
@@ -184,23 +274,26 @@ int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf) {
   *    Return Value:   0 - OK, Failed Address
   */
 unsigned long Verify (unsigned long adr, unsigned long sz, unsigned char *buf) {
-    unsigned char* ptr = (unsigned char*)(adr & 0x00FFFFFF);
+    uint32_t offset = (adr & QSPI_ADDR_MASK) - MUSCA_QSPI_FLASH_BASE;
     unsigned int i;
     unsigned char data[4];
-    ptr = ptr - MUSCA_QSPI_FLASH_BASE;
+    /* Command reads would wrap around on a smaller device */
+    if (offset + sz > ARM_FLASH0_DEV.dev->size) {
+        return adr;
+    }
 
     for (i = 0;  i < sz; i = i + 4)
     {
-        mt25ql_command_read(ARM_FLASH0_DEV.dev, (uint32_t)ptr, (uint8_t*) data, 4);
+        if (MT25QL_ERR_NONE != mt25ql_command_read(ARM_FLASH0_DEV.dev, offset + i, (uint8_t*) data, 4)) {
+            return (unsigned long)(adr + i);
+        }
         if( data[0] != buf[i + 0] ||
             data[1] != buf[i + 1] ||
             data[2] != buf[i + 2] ||
             data[3] != buf[i + 3] )
         {
-            return (unsigned long)(MUSCA_QSPI_FLASH_BASE + ptr + i);
+            return (unsigned long)(adr + i);
         }
-
-        ptr = ptr + 4;
     }
 
     return 0;
@@ -215,14 +308,18 @@ unsigned long Verify (unsigned long adr, unsigned long sz, unsigned char *buf) {
 
 int BlankCheck (unsigned long adr, unsigned long sz, unsigned char pat)
 {
-    unsigned char* ptr = (unsigned char*)(adr & 0x00FFFFFF);
+    uint32_t offset = (adr & QSPI_ADDR_MASK) - MUSCA_QSPI_FLASH_BASE;
     unsigned int i;
     unsigned char data[4];
-    ptr = ptr - MUSCA_QSPI_FLASH_BASE;
+    if (offset + sz > ARM_FLASH0_DEV.dev->size) {
+        return (1);
+    }
 
     for (i = 0;  i < sz; i = i + 4)
     {
-        mt25ql_command_read(ARM_FLASH0_DEV.dev, (uint32_t)ptr, data, 4);
+        if (MT25QL_ERR_NONE != mt25ql_command_read(ARM_FLASH0_DEV.dev, offset + i, data, 4)) {
+            return (1);
+        }
         if( data[0] != pat ||
             data[1] != pat ||
             data[2] != pat ||
@@ -230,8 +327,25 @@ int BlankCheck (unsigned long adr, unsigned long sz, unsigned char pat)
         {
             return (1);
         }
-
-        ptr = ptr + 4;
     }
     return (0);
 }
+
+/*
+ *  Read Flash Contents, used by CopyFlash
+ *    Parameter:      adr:  Start Address
+ *                    sz:   Size (in bytes)
+ *                    buf:  Data
+ *    Return Value:   0 - OK,  1 - Failed
+ */
+
+uint32_t ReadData (uint32_t adr, uint32_t sz, uint8_t *buf) {
+    uint32_t offset = (adr & QSPI_ADDR_MASK) - MUSCA_QSPI_FLASH_BASE;
+    if (offset + sz > ARM_FLASH0_DEV.dev->size) {
+        return 1;
+    }
+    if (MT25QL_ERR_NONE != mt25ql_command_read(ARM_FLASH0_DEV.dev, offset, buf, sz)) {
+        return 1;
+    }
+    return 0;
+}
@@ -20,6 +20,7 @@
 
 #include "mt25ql_flash_lib.h"
 #include "qspi_ip6514e_drv.h"
+#include "FlashWait.h"
 
 /** Setter bit manipulation macro */
 #define SET_BIT(WORD, BIT_INDEX) ((WORD) |= (1U << (BIT_INDEX)))
@@ -55,6 +56,22 @@
 #define QUAD_INPUT_FAST_PROGRAM_CMD         0x32U
 #define PAGE_PROGRAM_CMD                    0x02U
 
+/* The same commands taking a 4-byte address, whatever the address mode */
+#define SUBSECTOR_ERASE_32KB_CMD_4B         0x5CU
+#define SUBSECTOR_ERASE_4KB_CMD_4B          0x21U
+#define SECTOR_ERASE_CMD_4B                 0xDCU
+#define QUAD_OUTPUT_FAST_READ_CMD_4B        0x6CU
+#define FAST_READ_CMD_4B                    0x0CU
+#define READ_CMD_4B                         0x13U
+#define QUAD_INPUT_FAST_PROGRAM_CMD_4B      0x34U
+#define PAGE_PROGRAM_CMD_4B                 0x12U
+
+/* Opcode and number of address bytes for the address length of the device */
+#define OPCODE(dev, cmd) \
+            ((dev)->addr_bytes == ADDR_BYTES_4B ? cmd##_4B : cmd)
+#define ADDR_LEN(dev) \
+            ((dev)->addr_bytes == ADDR_BYTES_4B ? ADDR_BYTES_4B : ADDR_BYTES)
+
 /** MT25QL Enhanced Volatile Configuration Register access */
 #define ENHANCED_VOLATILE_CFG_REG_LEN      1U
 #define ENHANCED_VOLATILE_CFG_REG_QSPI_POS 7U
@@ -303,6 +320,10 @@ static enum mt25ql_error_t wait_program_or_erase_complete(
         if (controller_error != QSPI_IP6514E_ERR_NONE) {
             return (enum mt25ql_error_t)controller_error;
         }
+        if (!GET_BIT(flag_status_reg, FLAG_STATUS_REG_READY_POS)) {
+            /* Every poll is a command on the SPI bus, leave it some room. */
+            FlashWait_Idle();
+        }
     }
 
     return MT25QL_ERR_NONE;
@@ -406,23 +427,23 @@ enum mt25ql_error_t mt25ql_config_mode(struct mt25ql_dev_t* dev,
     switch(config) {
     case MT25QL_FUNC_STATE_DEFAULT:
         spi_mode            = QSPI_IP6514E_SPI_MODE;
-        opcode_read         = READ_CMD;
+        opcode_read         = OPCODE(dev, READ_CMD);
         dummy_cycles_read   = DEFAULT_READ_DUMMY_CYCLES;
-        opcode_write        = PAGE_PROGRAM_CMD;
+        opcode_write        = OPCODE(dev, PAGE_PROGRAM_CMD);
         dummy_cycles_write  = PAGE_PROGRAM_DUMMY_CYCLES;
         break;
     case MT25QL_FUNC_STATE_FAST:
         spi_mode            = QSPI_IP6514E_SPI_MODE;
-        opcode_read         = FAST_READ_CMD;
+        opcode_read         = OPCODE(dev, FAST_READ_CMD);
         dummy_cycles_read   = FAST_READ_DUMMY_CYCLES;
-        opcode_write        = PAGE_PROGRAM_CMD;
+        opcode_write        = OPCODE(dev, PAGE_PROGRAM_CMD);
         dummy_cycles_write  = PAGE_PROGRAM_DUMMY_CYCLES;
         break;
     case MT25QL_FUNC_STATE_QUAD_FAST:
         spi_mode            = QSPI_IP6514E_QSPI_MODE;
-        opcode_read         = QUAD_OUTPUT_FAST_READ_CMD;
+        opcode_read         = OPCODE(dev, QUAD_OUTPUT_FAST_READ_CMD);
         dummy_cycles_read   = QUAD_OUTPUT_FAST_READ_DUMMY_CYCLES;
-        opcode_write        = QUAD_INPUT_FAST_PROGRAM_CMD;
+        opcode_write        = OPCODE(dev, QUAD_INPUT_FAST_PROGRAM_CMD);
         dummy_cycles_write  = QUAD_INPUT_FAST_PROGRAM_DUMMY_CYCLES;
         break;
     default:
@@ -479,7 +500,7 @@ enum mt25ql_error_t mt25ql_config_mode(struct mt25ql_dev_t* dev,
     }
 
     controller_error = qspi_ip6514e_cfg_addr_bytes(dev->controller,
-                                                   ADDR_BYTES);
+                                                   ADDR_LEN(dev));
     if (controller_error != QSPI_IP6514E_ERR_NONE) {
         return (enum mt25ql_error_t)controller_error;
     }
@@ -548,7 +569,7 @@ enum mt25ql_error_t mt25ql_direct_read(struct mt25ql_dev_t* dev,
         return MT25QL_ERR_WRONG_ARGUMENT;
     }
 
-    if ((addr + len) >= dev->size) {
+    if ((addr + len) > dev->size) {
         return MT25QL_ERR_ADDR_TOO_BIG;
     }
 
@@ -606,7 +627,7 @@ enum mt25ql_error_t mt25ql_direct_write(struct mt25ql_dev_t* dev,
         return MT25QL_ERR_WRONG_ARGUMENT;
     }
 
-    if ((addr + len) >= dev->size) {
+    if ((addr + len) > dev->size) {
         return MT25QL_ERR_ADDR_TOO_BIG;
     }
 
@@ -703,16 +724,16 @@ enum mt25ql_error_t mt25ql_command_read(struct mt25ql_dev_t* dev,
 
     switch (dev->func_state) {
     case MT25QL_FUNC_STATE_QUAD_FAST:
-        opcode = QUAD_OUTPUT_FAST_READ_CMD;
+        opcode = OPCODE(dev, QUAD_OUTPUT_FAST_READ_CMD);
         dummy_cycles = QUAD_OUTPUT_FAST_READ_DUMMY_CYCLES;
         break;
     case MT25QL_FUNC_STATE_FAST:
-        opcode = FAST_READ_CMD;
+        opcode = OPCODE(dev, FAST_READ_CMD);
         dummy_cycles = FAST_READ_DUMMY_CYCLES;
         break;
     case MT25QL_FUNC_STATE_DEFAULT:
     default:
-        opcode = READ_CMD;
+        opcode = OPCODE(dev, READ_CMD);
         dummy_cycles = DEFAULT_READ_DUMMY_CYCLES;
         break;
     }
@@ -724,7 +745,7 @@ enum mt25ql_error_t mt25ql_command_read(struct mt25ql_dev_t* dev,
                                                     data,
                                                     CMD_DATA_MAX_SIZE,
                                                     addr,
-                                                    ADDR_BYTES,
+                                                    ADDR_LEN(dev),
                                                     dummy_cycles);
         if (controller_error != QSPI_IP6514E_ERR_NONE) {
             return (enum mt25ql_error_t)controller_error;
@@ -743,7 +764,7 @@ enum mt25ql_error_t mt25ql_command_read(struct mt25ql_dev_t* dev,
                                                      data,
                                                      len,
                                                      addr,
-                                                     ADDR_BYTES,
+                                                     ADDR_LEN(dev),
                                                      dummy_cycles);
         if (controller_error != QSPI_IP6514E_ERR_NONE) {
             return (enum mt25ql_error_t)controller_error;
@@ -767,13 +788,13 @@ enum mt25ql_error_t mt25ql_command_write(struct mt25ql_dev_t* dev,
 
     switch (dev->func_state) {
     case MT25QL_FUNC_STATE_QUAD_FAST:
-        opcode = QUAD_INPUT_FAST_PROGRAM_CMD;
+        opcode = OPCODE(dev, QUAD_INPUT_FAST_PROGRAM_CMD);
         dummy_cycles = QUAD_INPUT_FAST_PROGRAM_DUMMY_CYCLES;
         break;
     case MT25QL_FUNC_STATE_FAST:
     case MT25QL_FUNC_STATE_DEFAULT:
     default:
-        opcode = PAGE_PROGRAM_CMD;
+        opcode = OPCODE(dev, PAGE_PROGRAM_CMD);
         dummy_cycles = PAGE_PROGRAM_DUMMY_CYCLES;
         break;
     }
@@ -794,7 +815,7 @@ enum mt25ql_error_t mt25ql_command_write(struct mt25ql_dev_t* dev,
                                                     data,
                                                     CMD_DATA_MAX_SIZE,
                                                     addr,
-                                                    ADDR_BYTES,
+                                                    ADDR_LEN(dev),
                                                     dummy_cycles);
             if (library_error != MT25QL_ERR_NONE) {
                 return library_error;
@@ -807,7 +828,7 @@ enum mt25ql_error_t mt25ql_command_write(struct mt25ql_dev_t* dev,
                                                     data,
                                                     CMD_DATA_MAX_SIZE,
                                                     addr,
-                                                    ADDR_BYTES,
+                                                    ADDR_LEN(dev),
                                                     dummy_cycles);
             if (controller_error != QSPI_IP6514E_ERR_NONE) {
                 return (enum mt25ql_error_t)controller_error;
@@ -840,7 +861,7 @@ enum mt25ql_error_t mt25ql_command_write(struct mt25ql_dev_t* dev,
                                                     data,
                                                     len,
                                                     addr,
-                                                    ADDR_BYTES,
+                                                    ADDR_LEN(dev),
                                                     dummy_cycles);
             if (library_error != MT25QL_ERR_NONE) {
                 return library_error;
@@ -853,7 +874,7 @@ enum mt25ql_error_t mt25ql_command_write(struct mt25ql_dev_t* dev,
                                                     data,
                                                     len,
                                                     addr,
-                                                    ADDR_BYTES,
+                                                    ADDR_LEN(dev),
                                                     dummy_cycles);
             if (controller_error != QSPI_IP6514E_ERR_NONE) {
                 return (enum mt25ql_error_t)controller_error;
@@ -875,8 +896,22 @@ enum mt25ql_error_t mt25ql_erase(struct mt25ql_dev_t* dev,
                                  uint32_t addr,
                                  enum mt25ql_erase_t erase_type)
 {
-    enum qspi_ip6514e_error_t controller_error;
     enum mt25ql_error_t library_error;
+
+    library_error = mt25ql_erase_start(dev, addr, erase_type);
+    if (library_error != MT25QL_ERR_NONE) {
+        return library_error;
+    }
+
+    /* Wait until the erase operation is complete */
+    return wait_program_or_erase_complete(dev);
+}
+
+enum mt25ql_error_t mt25ql_erase_start(struct mt25ql_dev_t* dev,
+                                       uint32_t addr,
+                                       enum mt25ql_erase_t erase_type)
+{
+    enum qspi_ip6514e_error_t controller_error;
     uint8_t erase_cmd;
     uint32_t addr_bytes;
 
@@ -891,22 +926,22 @@ enum mt25ql_error_t mt25ql_erase(struct mt25ql_dev_t* dev,
         addr_bytes = ARG_NOT_USED;
         break;
     case MT25QL_ERASE_SECTOR_64K:
-        erase_cmd = SECTOR_ERASE_CMD;
-        addr_bytes = ADDR_BYTES;
+        erase_cmd = OPCODE(dev, SECTOR_ERASE_CMD);
+        addr_bytes = ADDR_LEN(dev);
         if ((addr % SECTOR_64KB) != 0) {
             return MT25QL_ERR_ADDR_NOT_ALIGNED;
         }
         break;
     case MT25QL_ERASE_SUBSECTOR_32K:
-        erase_cmd = SUBSECTOR_ERASE_32KB_CMD;
-        addr_bytes = ADDR_BYTES;
+        erase_cmd = OPCODE(dev, SUBSECTOR_ERASE_32KB_CMD);
+        addr_bytes = ADDR_LEN(dev);
         if ((addr % SUBSECTOR_32KB) != 0) {
             return MT25QL_ERR_ADDR_NOT_ALIGNED;
         }
         break;
     case MT25QL_ERASE_SUBSECTOR_4K:
-        erase_cmd = SUBSECTOR_ERASE_4KB_CMD;
-        addr_bytes = ADDR_BYTES;
+        erase_cmd = OPCODE(dev, SUBSECTOR_ERASE_4KB_CMD);
+        addr_bytes = ADDR_LEN(dev);
         if ((addr % SUBSECTOR_4KB) != 0) {
             return MT25QL_ERR_ADDR_NOT_ALIGNED;
         }
@@ -933,11 +968,10 @@ enum mt25ql_error_t mt25ql_erase(struct mt25ql_dev_t* dev,
         return (enum mt25ql_error_t)controller_error;
     }
 
-    /* Wait until the erase operation is complete */
-    library_error = wait_program_or_erase_complete(dev);
-    if (library_error != MT25QL_ERR_NONE) {
-         return (enum mt25ql_error_t)controller_error;
-    }
-
     return MT25QL_ERR_NONE;
 }
+
+enum mt25ql_error_t mt25ql_wait_complete(struct mt25ql_dev_t* dev)
+{
+    return wait_program_or_erase_complete(dev);
+}
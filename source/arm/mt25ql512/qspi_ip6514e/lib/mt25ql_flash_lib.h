@@ -36,6 +36,7 @@ extern "C" {
 #define SUBSECTOR_32KB      (0x00008000U)   /* 32KB */
 #define SECTOR_64KB         (0x00010000U)   /* 64KB */
 #define ADDR_BYTES          (3U)
+#define ADDR_BYTES_4B       (4U)            /* Devices over 16 MiB */
 
 enum mt25ql_error_t {
     MT25QL_ERR_NONE               = QSPI_IP6514E_ERR_NONE,
@@ -87,6 +88,11 @@ struct mt25ql_dev_t {
          *   dummy cycles and the Quad Input Fast Program with 0 dummy cycles.
          */
     uint32_t size; /*!< Total size of the MT25QL Flash memory */
+    uint32_t addr_bytes;
+        /*!< ADDR_BYTES_4B to use the 4-byte address opcodes, needed past the
+         *   first 16 MiB. Any other value keeps the 3-byte opcodes. The Flash
+         *   memory itself stays in 3-byte address mode.
+         */
     enum mt25ql_functional_state_t func_state;
         /*!< Functional state (operational parameter settings) of the
          *   QSPI Flash controller and memory.
@@ -243,6 +249,32 @@ enum mt25ql_error_t mt25ql_erase(struct mt25ql_dev_t* dev,
                                  uint32_t addr,
                                  enum mt25ql_erase_t erase_type);
 
+/**
+ * \brief Start erasing all flash memory, a sector (64 KiB) or a subsector
+ *        (32 KiB or 4 KiB) without waiting for its completion
+ *
+ * \param[in] dev        Pointer to MT25QL device structure \ref mt25ql_dev_t
+ * \param[in] addr       Address where to erase in the flash memory
+ * \param[in] erase_type Type of what to erase at the specified address
+ *
+ * \return Return error code as specified in \ref mt25ql_error_t
+ *
+ * \note The erase must be completed with \ref mt25ql_wait_complete before any
+ *       other program or erase is sent to the flash memory.
+ */
+enum mt25ql_error_t mt25ql_erase_start(struct mt25ql_dev_t* dev,
+                                       uint32_t addr,
+                                       enum mt25ql_erase_t erase_type);
+
+/**
+ * \brief Wait until the program or erase in progress is complete
+ *
+ * \param[in] dev     Pointer to MT25QL device structure \ref mt25ql_dev_t
+ *
+ * \return Return error code as specified in \ref mt25ql_error_t
+ */
+enum mt25ql_error_t mt25ql_wait_complete(struct mt25ql_dev_t* dev);
+
 #ifdef __cplusplus
 }
 #endif
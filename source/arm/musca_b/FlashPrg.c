@@ -0,0 +1,376 @@
+/* CMSIS-DAP Interface Firmware
+ * Copyright (c) 2009-2019 Arm Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FlashOS.H"        // FlashOS Structures
+#include "FlashJournal.h"
+#include "FlashSfdp.h"
+#include "FlashSparse.h"
+#include "FlashTiming.h"
+#include "gfc100_eflash_drv.h"
+#include "mt25ql_flash_lib.h"
+
+#define  SYSTEM_CLOCK    (40960000UL)
+
+/* Addresses from MUSCA_B_EFLASH_BASE upwards (in either security alias)
+ * belong to the embedded flash, everything below to the QSPI flash.
+ */
+#define IS_EFLASH_ADDR(adr)  (((adr) & 0x0FFFFFFF) >= MUSCA_B_EFLASH_BASE)
+#define EFLASH_OFFSET(adr)   (((adr) - MUSCA_B_EFLASH_BASE) & (GFC100_DEV_DATA.flash_size - 1))
+#define QSPI_OFFSET(adr)     (((adr) & 0x0FFFFFFF) - MUSCA_QSPI_FLASH_BASE)
+/* The offset macros fold unbacked addresses, such as the hole between the
+ * end of the QSPI flash and MUSCA_B_EFLASH_BASE, onto the devices. Every
+ * entry point rejects a range that is not fully backed first.
+ */
+#define IN_DEVICE(adr, sz)   (IS_EFLASH_ADDR(adr) ? \
+        (((adr) & 0x0FFFFFFF) - MUSCA_B_EFLASH_BASE + (sz) <= GFC100_DEV_DATA.flash_size) : \
+        (QSPI_OFFSET(adr) + (sz) <= MT25QL_DEV.size))
+#define QSPI_SECTOR_SIZE     0x10000     // See FlashDev.c
+
+/* With MUSCA_QSPI_DIRECT_WRITE pages are written through the AHB direct
+ * access window, the controller sends write enable and page program for
+ * the streamed words. STIG commands carry at most 8 bytes each.
+ */
+#ifdef MUSCA_QSPI_DIRECT_WRITE
+#define qspi_write  mt25ql_direct_write
+#else
+#define qspi_write  mt25ql_command_write
+#endif
+
+static uint32_t initialized = 0;
+
+static struct gfc100_eflash_dev_cfg_t GFC100_DEV_CFG = {
+    .base = MUSCA_B_EFLASH_REG_BASE,
+};
+
+static struct gfc100_eflash_dev_data_t GFC100_DEV_DATA = {
+    .is_initialized = false,
+    .flash_size = 0x400000,
+};
+
+static struct gfc100_eflash_dev_t GFC100_DEV;
+
+static const struct qspi_ip6514e_dev_cfg_t QSPI_DEV_CFG = {
+    .base = MUSCA_QSPI_REG_BASE,
+    .addr_mask = (1U << 18) - 1, /* 256 KiB minus 1 byte */
+};
+
+static struct qspi_ip6514e_dev_t QSPI_DEV;
+
+static struct mt25ql_dev_t MT25QL_DEV = {
+    .direct_access_start_addr = MUSCA_QSPI_FLASH_BASE,
+    .baud_rate_div = 4U,
+    .size = 0x00800000U, /* 8 MiB */
+};
+
+/* Erase used for a QSPI sector, picked from the SFDP erase types at Init */
+static enum mt25ql_erase_t qspi_erase_type;
+static uint32_t qspi_erase_size;
+
+static uint32_t sfdp_read (uint32_t adr, uint32_t sz, uint8_t *buf) {
+    return qspi_ip6514e_send_read_cmd(MT25QL_DEV.controller, SFDP_READ_CMD,
+                                      buf, sz, adr, 3, SFDP_READ_DUMMY);
+}
+
+/*
+ *  Match the QSPI device parameters against what mt25ql_flash_lib supports,
+ *  devices without SFDP keep the 64kB sector erase
+ */
+
+static void qspi_discover (void) {
+    sfdp_info_t info = {0};
+    uint8_t opcode = 0;
+
+    qspi_erase_type = MT25QL_ERASE_SECTOR_64K;
+    qspi_erase_size = QSPI_SECTOR_SIZE;
+    if (Sfdp_Parse(sfdp_read, &info) != 0) {
+        return;
+    }
+    // Past 16 MiB the library switches to the 4 byte address opcodes
+    if (info.density != 0) {
+        MT25QL_DEV.size = info.density;
+        MT25QL_DEV.addr_bytes = info.density > 0x01000000 ? ADDR_BYTES_4B : ADDR_BYTES;
+    }
+    // Only use an erase type if its opcode is the one the library sends
+    switch (Sfdp_EraseSize(&info, QSPI_SECTOR_SIZE, &opcode)) {
+        case 0x8000:
+            if (opcode == 0x52) {
+                qspi_erase_type = MT25QL_ERASE_SUBSECTOR_32K;
+                qspi_erase_size = 0x8000;
+            }
+            break;
+        case 0x1000:
+            if (opcode == 0x20) {
+                qspi_erase_type = MT25QL_ERASE_SUBSECTOR_4K;
+                qspi_erase_size = 0x1000;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ *  Initialize Flash Programming Functions
+ *    Parameter:      adr:  Device Base Address
+ *                    clk:  Clock Frequency (Hz)
+ *                    fnc:  Function Code (1 - Erase, 2 - Program, 3 - Verify)
+ *    Return Value:   0 - OK,  1 - Failed
+ */
+
+int Init (unsigned long adr, unsigned long clk, unsigned long fnc) {
+    if(initialized == 0) {
+        /* For PIC the following assignments have to be in a function (run time) */
+        GFC100_DEV.data = &GFC100_DEV_DATA;
+        GFC100_DEV.cfg = &GFC100_DEV_CFG;
+        gfc100_eflash_init(&GFC100_DEV, SYSTEM_CLOCK);
+
+        QSPI_DEV.cfg = &QSPI_DEV_CFG;
+        MT25QL_DEV.controller = &QSPI_DEV;
+        qspi_ip6514e_enable(MT25QL_DEV.controller);
+        qspi_discover();
+
+        /* Configure QSPI Flash controller to operate in single SPI mode and
+         * to use fast Flash commands, with the address length found above */
+        if (MT25QL_ERR_NONE != mt25ql_config_mode(&MT25QL_DEV, MT25QL_FUNC_STATE_FAST)) {
+              return 1;
+        }
+        initialized = 1;
+    }
+    return 0;
+}
+
+
+/*
+ *  De-Initialize Flash Programming Functions
+ *    Parameter:      fnc:  Function Code (1 - Erase, 2 - Program, 3 - Verify)
+ *    Return Value:   0 - OK,  1 - Failed
+ */
+
+int UnInit (unsigned long fnc) {
+    if(fnc == 0 && initialized == 1) {
+        /* Restores the QSPI Flash controller and MT25QL to default state */
+        if (MT25QL_ERR_NONE != mt25ql_restore_default_state(&MT25QL_DEV)) {
+            return 1;
+        }
+        initialized = 0;
+    }
+    return 0;
+}
+
+
+/*
+ *  Erase complete Flash Memory
+ *    Return Value:   0 - OK,  1 - Failed
+ */
+
+int EraseChip (void) {
+    int ret = 0;
+
+    FlashTiming_Start();
+    /* Both mass erases run concurrently, and both are complete on return */
+    if (GFC100_ERROR_NONE != gfc100_eflash_erase_start(&GFC100_DEV, 0, GFC100_MASS_ERASE_ALL)) {
+        FlashTiming_Stop();
+        return 1;
+    }
+    if (MT25QL_ERR_NONE != mt25ql_erase_start(&MT25QL_DEV, 0, MT25QL_ERASE_ALL_FLASH)) {
+        ret = 1;
+    } else if (MT25QL_ERR_NONE != mt25ql_wait_complete(&MT25QL_DEV)) {
+        ret = 1;
+    }
+    if (GFC100_ERROR_NONE != gfc100_eflash_wait(&GFC100_DEV)) {
+        ret = 1;
+    }
+    if (ret == 0) {
+        FlashTiming_Erased(FLASH_TIMING_CHIP);
+        FlashJournal_Erased(FLASH_JOURNAL_CHIP);
+    } else {
+        FlashTiming_Stop();
+    }
+    return ret;
+}
+
+
+/*
+ *  Erase Sector in Flash Memory
+ *    Parameter:      adr:  Sector Address
+ *    Return Value:   0 - OK,  1 - Failed
+ */
+
+int EraseSector (unsigned long adr) {
+    uint32_t i;
+
+    if (!IN_DEVICE(adr, 1)) {
+        return 1;
+    }
+    FlashTiming_Start();
+    if (IS_EFLASH_ADDR(adr)) {
+        if (GFC100_ERROR_NONE != gfc100_eflash_erase(&GFC100_DEV, EFLASH_OFFSET(adr), GFC100_ERASE_PAGE)) {
+            FlashTiming_Stop();
+            return 1;
+        }
+        FlashTiming_Erased(gfc100_get_eflash_page_size(&GFC100_DEV));
+    } else {
+        for (i = 0; i < QSPI_SECTOR_SIZE; i += qspi_erase_size) {
+            if (MT25QL_ERR_NONE != mt25ql_erase(&MT25QL_DEV, QSPI_OFFSET(adr) + i, qspi_erase_type)) {
+                FlashTiming_Stop();
+                return 1;
+            }
+        }
+        FlashTiming_Erased(QSPI_SECTOR_SIZE);
+    }
+    FlashJournal_Erased(adr);
+    return 0;
+}
+
+
+/*
+ *  Program Page in Flash Memory
+ *    Parameter:      adr:  Page Start Address
+ *                    sz:   Page Size
+ *                    buf:  Page Data
+ *    Return Value:   0 - OK,  1 - Failed
+ */
+
+int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf) {
+    uint32_t len = sz;
+    uint32_t ofs;
+
+    if (!IN_DEVICE(adr, sz)) {
+        return 1;
+    }
+    FlashTiming_Start();
+    if (IS_EFLASH_ADDR(adr)) {
+        if (GFC100_ERROR_NONE != gfc100_eflash_write(&GFC100_DEV, EFLASH_OFFSET(adr), buf, &len)) {
+            FlashTiming_Stop();
+            return 1;
+        }
+    } else {
+        /* Erased bytes are skipped, see FlashSparse.h */
+        for (ofs = 0; (len = FlashSparse_NextRun(buf, sz, &ofs)) != 0; ofs += len) {
+            if (MT25QL_ERR_NONE != qspi_write(&MT25QL_DEV, QSPI_OFFSET(adr) + ofs, buf + ofs, len)) {
+                FlashTiming_Stop();
+                return 1;
+            }
+        }
+    }
+    FlashTiming_Programmed(sz);
+    FlashJournal_Programmed(adr, sz);
+    return 0;
+}
+
+ /*
+  *  Verify Flash Contents
+  *    Parameter:      adr:  Start Address
+  *                    sz:   Size (in bytes)
+  *                    buf:  Data
+  *    Return Value:   0 - OK, Failed Address
+  */
+unsigned long Verify (unsigned long adr, unsigned long sz, unsigned char *buf) {
+    uint32_t len = 4;
+    uint32_t offset;
+    unsigned int i, j;
+    unsigned char data[4];
+
+    if (!IN_DEVICE(adr, sz)) {
+        return adr;
+    }
+    if (IS_EFLASH_ADDR(adr)) {
+        offset = EFLASH_OFFSET(adr);
+    } else {
+        offset = QSPI_OFFSET(adr);
+    }
+
+    for (i = 0;  i < sz; i = i + 4)
+    {
+        if (IS_EFLASH_ADDR(adr)) {
+            gfc100_eflash_read(&GFC100_DEV, offset + i, (uint8_t*) data, &len);
+        } else {
+            mt25ql_command_read(&MT25QL_DEV, offset + i, (uint8_t*) data, 4);
+        }
+        for (j = 0; j < 4; j++) {
+            if( data[j] != buf[i + j] )
+            {
+                return (unsigned long)(adr + i);
+            }
+        }
+    }
+    return 0;
+}
+
+/*  Blank Check Block in Flash Memory
+ *    Parameter:      adr:  Block Start Address
+ *                    sz:   Block Size (in bytes)
+ *                    pat:  Block Pattern
+ *    Return Value:   0 - OK,  1 - Failed
+ */
+
+int BlankCheck (unsigned long adr, unsigned long sz, unsigned char pat) {
+    uint32_t len = 4;
+    uint32_t offset;
+    unsigned int i, j;
+    unsigned char data[4];
+
+    if (!IN_DEVICE(adr, sz)) {
+        return 1;
+    }
+    if (IS_EFLASH_ADDR(adr)) {
+        offset = EFLASH_OFFSET(adr);
+    } else {
+        offset = QSPI_OFFSET(adr);
+    }
+
+    for (i = 0;  i < sz; i = i + 4)
+    {
+        if (IS_EFLASH_ADDR(adr)) {
+            gfc100_eflash_read(&GFC100_DEV, offset + i, (uint8_t*) data, &len);
+        } else {
+            mt25ql_command_read(&MT25QL_DEV, offset + i, (uint8_t*) data, 4);
+        }
+        for (j = 0; j < 4; j++) {
+            if( data[j] != pat )
+            {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ *  Read Flash Contents, used by CopyFlash
+ *    Parameter:      adr:  Start Address
+ *                    sz:   Size (in bytes)
+ *                    buf:  Data
+ *    Return Value:   0 - OK,  1 - Failed
+ */
+
+uint32_t ReadData (uint32_t adr, uint32_t sz, uint8_t *buf) {
+    uint32_t len = sz;
+
+    if (!IN_DEVICE(adr, sz)) {
+        return 1;
+    }
+    if (IS_EFLASH_ADDR(adr)) {
+        if (GFC100_ERROR_NONE != gfc100_eflash_read(&GFC100_DEV, EFLASH_OFFSET(adr), buf, &len)) {
+            return 1;
+        }
+    } else {
+        if (MT25QL_ERR_NONE != mt25ql_command_read(&MT25QL_DEV, QSPI_OFFSET(adr), buf, sz)) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,45 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file FlashChunk.c */
+
+#include "../FlashPrg.h"
+#include "../FlashChunk.h"
+
+static uint32_t chunk_buf[FLASH_CHUNK_SIZE / 4];
+
+uint8_t *FlashChunk_Buffer(void)
+{
+    return (uint8_t *)chunk_buf;
+}
+
+uint32_t FlashChunk_Size(uint32_t adr, uint32_t sz)
+{
+    uint32_t len = FLASH_CHUNK_SIZE - (adr % FLASH_CHUNK_SIZE);
+
+    return len > sz ? sz : len;
+}
+
+uint32_t FlashChunk_Program(uint32_t adr, uint32_t len)
+{
+    uint8_t *buf = (uint8_t *)chunk_buf;
+    uint32_t i;
+
+    for (i = len; i < FLASH_CHUNK_SIZE; i++) {
+        buf[i] = FLASH_ERASED_BYTE;
+    }
+    return ProgramPage(adr, len, chunk_buf);
+}
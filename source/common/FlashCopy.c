@@ -0,0 +1,44 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file FlashCopy.c */
+
+#include "../FlashPrg.h"
+#include "../FlashChunk.h"
+
+uint32_t CopyFlash(uint32_t src, uint32_t dst, uint32_t sz)
+{
+    uint8_t *buf = FlashChunk_Buffer();
+    uint32_t len;
+
+    if ((dst & 3) || (sz & 3)) {
+        return 1;
+    }
+
+    while (sz > 0) {
+        len = FlashChunk_Size(dst, sz);
+        if (ReadData(src, len, buf) != 0) {
+            return 1;
+        }
+        if (FlashChunk_Program(dst, len) != 0) {
+            return 1;
+        }
+        src += len;
+        dst += len;
+        sz -= len;
+    }
+    return 0;
+}
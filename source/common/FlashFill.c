@@ -0,0 +1,44 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file FlashFill.c */
+
+#include "../FlashPrg.h"
+#include "../FlashChunk.h"
+
+uint32_t ProgramFill(uint32_t adr, uint32_t sz, uint32_t pattern)
+{
+    uint32_t *buf = (uint32_t *)FlashChunk_Buffer();
+    uint32_t len, i;
+
+    if ((adr & 3) || (sz & 3)) {
+        return 1;
+    }
+
+    while (sz > 0) {
+        len = FlashChunk_Size(adr, sz);
+        // Refilled every time, ProgramPage may modify the buffer
+        for (i = 0; i < len / 4; i++) {
+            buf[i] = pattern;
+        }
+        if (FlashChunk_Program(adr, len) != 0) {
+            return 1;
+        }
+        adr += len;
+        sz -= len;
+    }
+    return 0;
+}
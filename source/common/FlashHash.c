@@ -0,0 +1,53 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file FlashHash.c */
+
+#include "../FlashPrg.h"
+
+// For memory mapped flash only, the contents are read directly
+
+uint32_t HashBlocks(uint32_t adr, uint32_t sz, uint32_t blk, uint32_t *out)
+{
+    const uint8_t *ptr = (const uint8_t *)adr;
+    uint32_t len, a, b, crc, i, j;
+
+    if (blk == 0) {
+        return 1;
+    }
+
+    while (sz > 0) {
+        len = (sz < blk) ? sz : blk;
+        a = 0;
+        b = 0;
+        crc = 0xFFFFFFFF;
+        for (i = 0; i < len; i++) {
+            uint8_t data = *ptr++;
+            // Weak checksum, can be rolled byte by byte on the host
+            a += data;
+            b += a;
+            // Strong checksum, reflected CRC-32
+            crc ^= data;
+            for (j = 0; j < 8; j++) {
+                crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+            }
+        }
+        *out++ = (a & 0xFFFF) | (b << 16);
+        *out++ = ~crc;
+        sz -= len;
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file FlashJournal.c */
+
+#include "../FlashJournal.h"
+
+// Read and reset by the host, see the generated blobs. On the target only
+// this file accesses it, so GCC reaches it PC relative.
+volatile flash_journal_t FlashJournal;
+
+static void FlashJournal_Start(void)
+{
+    if (FlashJournal.magic != FLASH_JOURNAL_MAGIC) {
+        FlashJournal.erased = FLASH_JOURNAL_NONE;
+        FlashJournal.programmed = FLASH_JOURNAL_NONE;
+        FlashJournal.count = 0;
+        FlashJournal.magic = FLASH_JOURNAL_MAGIC;
+    }
+}
+
+void FlashJournal_Erased(uint32_t adr)
+{
+    FlashJournal_Start();
+    if (adr == FLASH_JOURNAL_CHIP) {
+        // Everything programmed so far is gone
+        FlashJournal.programmed = FLASH_JOURNAL_NONE;
+    }
+    FlashJournal.erased = adr;
+    FlashJournal.count++;
+}
+
+void FlashJournal_Programmed(uint32_t adr, uint32_t sz)
+{
+    FlashJournal_Start();
+    FlashJournal.programmed = adr + sz;
+    FlashJournal.count++;
+}
@@ -0,0 +1,94 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file FlashPartial.c */
+
+#include "../FlashPrg.h"
+
+// Program unit, ProgramPage is always called with one whole aligned unit
+#ifndef FLASH_PARTIAL_UNIT
+#define FLASH_PARTIAL_UNIT 256
+#endif
+
+// Define FLASH_PARTIAL_ONCE if a unit must not be programmed twice between
+// erases, as with Kinetis phrases or the STM32L0/L1 NOTZEROERR check.
+
+static uint32_t unit_buf[FLASH_PARTIAL_UNIT / 4];
+
+#ifdef FLASH_PARTIAL_ONCE
+static uint32_t unit_programmed(const uint8_t *unit)
+{
+    uint32_t i;
+
+    for (i = 0; i < FLASH_PARTIAL_UNIT; i++) {
+        if (unit[i] != FLASH_ERASED_BYTE) {
+            return 1;
+        }
+    }
+    return 0;
+}
+#endif
+
+uint32_t ProgramPartial(uint32_t adr, uint32_t sz, uint32_t *buf)
+{
+    uint8_t *unit = (uint8_t *)unit_buf;
+    const uint8_t *src = (const uint8_t *)buf;
+    uint32_t base, ofs, len, i, changed;
+#ifdef FLASH_PARTIAL_ONCE
+    uint32_t programmed;
+#endif
+
+    while (sz > 0) {
+        base = adr - (adr % FLASH_PARTIAL_UNIT);
+        ofs = adr - base;
+        len = FLASH_PARTIAL_UNIT - ofs;
+        if (len > sz) {
+            len = sz;
+        }
+        // Read every time, ProgramPage may modify the buffer
+        if (ReadData(base, FLASH_PARTIAL_UNIT, unit) != 0) {
+            return 1;
+        }
+#ifdef FLASH_PARTIAL_ONCE
+        programmed = unit_programmed(unit);
+#endif
+        changed = 0;
+        for (i = 0; i < len; i++) {
+            if (unit[ofs + i] == src[i]) {
+                continue;
+            }
+            // Bits can only move away from the erased state
+            if ((unit[ofs + i] ^ FLASH_ERASED_BYTE) & ~(src[i] ^ FLASH_ERASED_BYTE) & 0xFF) {
+                return 1;
+            }
+            unit[ofs + i] = src[i];
+            changed = 1;
+        }
+#ifdef FLASH_PARTIAL_ONCE
+        if (changed && programmed) {
+            return 1;
+        }
+#endif
+        if (changed && ProgramPage(base, FLASH_PARTIAL_UNIT, unit_buf) != 0) {
+            return 1;
+        }
+        adr += len;
+        src += len;
+        sz -= len;
+    }
+    return 0;
+}
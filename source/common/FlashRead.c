@@ -0,0 +1,33 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file FlashRead.c */
+
+#include "../FlashPrg.h"
+
+// Memory mapped ReadData for CopyFlash and ProgramPartial, algos for
+// devices that are not memory mapped implement their own instead.
+
+uint32_t ReadData(uint32_t adr, uint32_t sz, uint8_t *buf)
+{
+    const uint8_t *ptr = (const uint8_t *)adr;
+
+    while (sz--) {
+        *buf++ = *ptr++;
+    }
+    return 0;
+}
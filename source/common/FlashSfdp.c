@@ -0,0 +1,116 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file FlashSfdp.c */
+
+#include "../FlashSfdp.h"
+
+#define SFDP_SIGNATURE      0x50444653  // "SFDP"
+#define SFDP_BFPT_ID        0xFF00
+#define SFDP_MAX_HEADERS    8
+#define SFDP_BFPT_DWORDS    16          // JESD216B, later DWORDs are not used
+
+// BFPT DWORDs are numbered from 1 in the standard
+#define DW(n)               (bfpt[(n) - 1])
+
+uint32_t Sfdp_Parse(sfdp_read_t read, sfdp_info_t *info)
+{
+    uint32_t hdr[2];
+    uint32_t bfpt[SFDP_BFPT_DWORDS];
+    uint32_t nph, len, ptr, i, n;
+
+    if (read(0, sizeof(hdr), (uint8_t *)hdr) || hdr[0] != SFDP_SIGNATURE) {
+        return 1;
+    }
+
+    // Use the longest (most recent) basic flash parameter table
+    nph = ((hdr[1] >> 16) & 0xFF) + 1;
+    if (nph > SFDP_MAX_HEADERS) {
+        nph = SFDP_MAX_HEADERS;
+    }
+    len = 0;
+    ptr = 0;
+    for (i = 0; i < nph; i++) {
+        if (read(8 + i * 8, sizeof(hdr), (uint8_t *)hdr)) {
+            return 1;
+        }
+        if (((hdr[0] & 0xFF) | ((hdr[1] >> 16) & 0xFF00)) == SFDP_BFPT_ID &&
+            (hdr[0] >> 24) > len) {
+            len = hdr[0] >> 24;
+            ptr = hdr[1] & 0x00FFFFFF;
+        }
+    }
+    if (len < 9) {
+        return 1;
+    }
+    if (len > SFDP_BFPT_DWORDS) {
+        len = SFDP_BFPT_DWORDS;
+    }
+    if (read(ptr, len * 4, (uint8_t *)bfpt)) {
+        return 1;
+    }
+
+    if (DW(2) & 0x80000000) {
+        n = DW(2) & 0x7FFFFFFF;
+        info->density = (n >= 3 && n < 35) ? 1UL << (n - 3) : 0;
+    } else {
+        info->density = (DW(2) >> 3) + 1;
+    }
+
+    for (i = 0; i < SFDP_ERASE_TYPES; i++) {
+        n = (DW(8 + i / 2) >> ((i % 2) * 16)) & 0xFFFF;
+        info->erase_size[i] = (n & 0xFF) ? 1UL << (n & 0xFF) : 0;
+        info->erase_opcode[i] = n >> 8;
+    }
+
+    switch ((DW(1) >> 17) & 0x3) {
+        case 2:
+            info->addr_bytes = 4;
+            break;
+        case 1:
+            info->addr_bytes = info->density > 0x01000000 ? 4 : 3;
+            break;
+        default:
+            info->addr_bytes = 3;
+            break;
+    }
+
+    if (len >= 11) {
+        info->page_size = 1UL << ((DW(11) >> 4) & 0xF);
+    }
+    if (len >= 15) {
+        info->quad_enable = (DW(15) >> 20) & 0x7;
+    }
+    if (len >= 16) {
+        info->enter_4byte = DW(16) >> 24;
+    }
+    return 0;
+}
+
+uint32_t Sfdp_EraseSize(const sfdp_info_t *info, uint32_t sz, uint8_t *opcode)
+{
+    uint32_t best = 0;
+    uint32_t i;
+
+    for (i = 0; i < SFDP_ERASE_TYPES; i++) {
+        if (info->erase_size[i] > best && info->erase_size[i] <= sz &&
+            (sz % info->erase_size[i]) == 0) {
+            best = info->erase_size[i];
+            *opcode = info->erase_opcode[i];
+        }
+    }
+    return best;
+}
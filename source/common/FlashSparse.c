@@ -0,0 +1,55 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file FlashSparse.c */
+
+#include "../FlashSparse.h"
+
+#define ERASED_BYTE 0xFF    // SPI-NOR devices erase to all ones
+
+uint32_t FlashSparse_NextRun(const uint8_t *buf, uint32_t sz, uint32_t *ofs)
+{
+    uint32_t start = *ofs;
+    uint32_t end;
+    uint32_t gap = 0;
+    uint32_t i;
+
+    while (start < sz && buf[start] == ERASED_BYTE) {
+        start++;
+    }
+    if (start >= sz) {
+        *ofs = sz;
+        return 0;
+    }
+    start &= ~(FLASH_SPARSE_ALIGN - 1);
+
+    end = start;
+    for (i = start; i < sz; i++) {
+        if (buf[i] != ERASED_BYTE) {
+            end = i + 1;
+            gap = 0;
+        } else if (++gap >= FLASH_SPARSE_GAP) {
+            break;
+        }
+    }
+    end = (end + FLASH_SPARSE_ALIGN - 1) & ~(FLASH_SPARSE_ALIGN - 1);
+    if (end > sz) {
+        end = sz;
+    }
+
+    *ofs = start;
+    return end - start;
+}
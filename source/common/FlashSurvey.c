@@ -0,0 +1,76 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file FlashSurvey.c */
+
+#include "../FlashPrg.h"
+
+uint32_t SectorScan(uint32_t adr, uint32_t sz)
+{
+    const uint32_t *ptr = (const uint32_t *)adr;
+    uint32_t erased = 0;
+    uint32_t programmed = 0;
+    uint32_t empty = FLASH_ERASED_BYTE * 0x01010101U;
+
+    for (; sz >= 4; sz -= 4) {
+        if (*ptr++ == empty) {
+            erased = 1;
+        } else {
+            programmed = 1;
+        }
+        if (erased && programmed) {
+            return SECTOR_PARTIAL;
+        }
+    }
+    return programmed ? SECTOR_FULL : SECTOR_BLANK;
+}
+
+// Without a sector size there is nothing to survey
+#if defined(FLASH_SURVEY_CUSTOM) || defined(FLASH_SECTOR_SIZE)
+
+#ifndef FLASH_SURVEY_CUSTOM
+uint32_t SectorSize(uint32_t adr)
+{
+    return FLASH_SECTOR_SIZE;
+}
+
+uint32_t SectorState(uint32_t adr, uint32_t sz)
+{
+    return SectorScan(adr, sz);
+}
+#endif
+
+uint32_t SurveySectors(uint32_t start, uint32_t end, uint32_t *bitmap)
+{
+    uint32_t n = 0;
+    uint32_t size;
+
+    while (start < end) {
+        size = SectorSize(start);
+        if (size == 0) {
+            return 1;
+        }
+        if ((n % 16) == 0) {
+            bitmap[n / 16] = 0;
+        }
+        bitmap[n / 16] |= SectorState(start, size) << ((n % 16) * 2);
+        start += size;
+        n++;
+    }
+    return 0;
+}
+
+#endif
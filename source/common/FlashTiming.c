@@ -0,0 +1,118 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file FlashTiming.c */
+
+#include "../FlashTiming.h"
+#include "../FlashWait.h"
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || \
+    defined(__ARM_ARCH_8M_MAIN__) || \
+    defined(__TARGET_ARCH_7_M) || defined(__TARGET_ARCH_7E_M)
+#define FLASH_TIMING_DWT
+#endif
+
+#ifdef FLASH_TIMING_DWT
+#define DEMCR           (*(volatile uint32_t *)0xE000EDFC)
+#define DWT_CTRL        (*(volatile uint32_t *)0xE0001000)
+#define DWT_CYCCNT      (*(volatile uint32_t *)0xE0001004)
+#define DEMCR_TRCENA    (1UL << 24)
+#define DWT_CYCCNTENA   (1UL << 0)
+#define DWT_NOCYCCNT    (1UL << 25)
+#endif
+
+// Unit when counting FlashWait_Idle calls, which only pause without an IRQ
+#ifdef FLASH_WAIT_IRQ
+#define FLASH_TIMING_LOOPS  FLASH_TIMING_NONE
+#else
+#define FLASH_TIMING_LOOPS  FLASH_WAIT_PACE
+#endif
+
+// Read by the host, see the generated blobs
+volatile flash_timing_t FlashTiming;
+
+static uint32_t start;
+#ifdef FLASH_TIMING_DWT
+static uint32_t saved_demcr;
+static uint32_t saved_dwt_ctrl;
+#endif
+
+static uint32_t now(void)
+{
+#ifdef FLASH_TIMING_DWT
+    if (FlashTiming.unit == FLASH_TIMING_CYCLES) {
+        return DWT_CYCCNT;
+    }
+#endif
+    return FlashWait_Count();
+}
+
+void FlashTiming_Start(void)
+{
+#ifdef FLASH_TIMING_DWT
+    saved_demcr = DEMCR;
+    DEMCR = saved_demcr | DEMCR_TRCENA;
+    saved_dwt_ctrl = DWT_CTRL;
+    if (saved_dwt_ctrl & DWT_NOCYCCNT) {
+        FlashTiming.unit = FLASH_TIMING_LOOPS;
+    } else {
+        DWT_CTRL = saved_dwt_ctrl | DWT_CYCCNTENA;
+        FlashTiming.unit = FLASH_TIMING_CYCLES;
+    }
+#else
+    FlashTiming.unit = FLASH_TIMING_LOOPS;
+#endif
+    start = now();
+}
+
+void FlashTiming_Stop(void)
+{
+#ifdef FLASH_TIMING_DWT
+    // Only the bits set by FlashTiming_Start, the debugger owns the rest
+    if (FlashTiming.unit == FLASH_TIMING_CYCLES) {
+        DWT_CTRL = (DWT_CTRL & ~DWT_CYCCNTENA) | (saved_dwt_ctrl & DWT_CYCCNTENA);
+    }
+    DEMCR = (DEMCR & ~DEMCR_TRCENA) | (saved_demcr & DEMCR_TRCENA);
+#endif
+}
+
+void FlashTiming_Erased(uint32_t sz)
+{
+    uint32_t elapsed = now() - start;
+    uint32_t i;
+
+    FlashTiming_Stop();
+    if (sz == FLASH_TIMING_CHIP) {
+        FlashTiming.chip = elapsed;
+        return;
+    }
+    // Reuse the slot of this size, or take the first free one
+    for (i = 0; i < FLASH_TIMING_SIZES; i++) {
+        if (FlashTiming.erase_size[i] == sz || FlashTiming.erase_size[i] == 0) {
+            FlashTiming.erase_size[i] = sz;
+            FlashTiming.erase[i] = elapsed;
+            return;
+        }
+    }
+}
+
+void FlashTiming_Programmed(uint32_t sz)
+{
+    FlashTiming.program = now() - start;
+    FlashTiming.program_size = sz;
+    FlashTiming_Stop();
+}
@@ -0,0 +1,93 @@
+/* Flash OS Routines
+ * Copyright (c) 2009-2015 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file FlashWait.c */
+
+#include "../FlashWait.h"
+
+static uint32_t idle_count;
+
+uint32_t FlashWait_Count(void)
+{
+    return idle_count;
+}
+
+#ifdef FLASH_WAIT_IRQ
+
+// Core registers, common to all Cortex-M
+#define SCB_SCR         (*(volatile uint32_t *)0xE000ED10)
+#define NVIC_ISER       ((volatile uint32_t *)0xE000E100)
+#define NVIC_ICER       ((volatile uint32_t *)0xE000E180)
+#define NVIC_ICPR       ((volatile uint32_t *)0xE000E280)
+#define SCR_SEVONPEND   (1UL << 4)
+
+static uint32_t irq_word;
+static uint32_t irq_bit;
+static uint32_t saved_scr;
+static uint32_t saved_enable;
+
+void FlashWait_Start(uint32_t irq)
+{
+    irq_word = irq >> 5;
+    irq_bit = 1UL << (irq & 31);
+    // The interrupt must not be taken, the handler belongs to the target
+    saved_enable = NVIC_ISER[irq_word] & irq_bit;
+    NVIC_ICER[irq_word] = irq_bit;
+    NVIC_ICPR[irq_word] = irq_bit;
+    saved_scr = SCB_SCR;
+    SCB_SCR = saved_scr | SCR_SEVONPEND;
+}
+
+void FlashWait_Idle(void)
+{
+    idle_count++;
+    // Returns at once if an event is latched, the caller polls again
+#if defined(__CC_ARM)
+    __wfe();
+#else
+    __asm volatile ("wfe");
+#endif
+}
+
+void FlashWait_Stop(void)
+{
+    NVIC_ICPR[irq_word] = irq_bit;
+    SCB_SCR = saved_scr;
+    if (saved_enable) {
+        NVIC_ISER[irq_word] = irq_bit;
+    }
+}
+
+#else
+
+void FlashWait_Start(uint32_t irq)
+{
+}
+
+void FlashWait_Idle(void)
+{
+    volatile uint32_t n;
+
+    idle_count++;
+    for (n = FLASH_WAIT_PACE; n > 0; n--) {
+    }
+}
+
+void FlashWait_Stop(void)
+{
+}
+
+#endif
@@ -15,14 +15,17 @@
  */
 
 #include "FlashOS.H"        // FlashOS Structures
+#include "FlashPrg.h"
+#include "FlashJournal.h"
+#include "FlashTiming.h"
 #include "fsl_flash.h"
 #include "string.h"
 
 //! Pre-shifted value of RUNM field when set to VLPR mode.
 #define SMC_PMCTRL_RUNM_VLPR (SMC_PMCTRL_RUNM(0x02))
 
-flash_config_t g_flash; //!< Storage for flash driver.
-bool g_wasInVlpr; //!< Saved VLPR mode flag.
+static flash_config_t g_flash; //!< Storage for flash driver.
+static bool g_wasInVlpr; //!< Saved VLPR mode flag.
 
 uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
 {
@@ -139,11 +142,23 @@ uint32_t UnInit(uint32_t fnc)
  */
 uint32_t EraseChip(void)
 {
-    int status = FLASH_EraseAll(&g_flash, kFLASH_apiEraseKey);
+    int status;
+
+    FlashTiming_Start();
+    status = FLASH_EraseAll(&g_flash, kFLASH_apiEraseKey);
     if (status == kStatus_Success)
     {
         status = FLASH_VerifyEraseAll(&g_flash, kFLASH_marginValueNormal);
     }
+    if (status == kStatus_Success)
+    {
+        FlashTiming_Erased(FLASH_TIMING_CHIP);
+        FlashJournal_Erased(FLASH_JOURNAL_CHIP);
+    }
+    else
+    {
+        FlashTiming_Stop();
+    }
     return status;
 }
 
@@ -155,11 +170,23 @@ uint32_t EraseChip(void)
  */
 uint32_t EraseSector(uint32_t adr)
 {
-    int status = FLASH_Erase(&g_flash, adr, g_flash.PFlashSectorSize, kFLASH_apiEraseKey);
+    int status;
+
+    FlashTiming_Start();
+    status = FLASH_Erase(&g_flash, adr, g_flash.PFlashSectorSize, kFLASH_apiEraseKey);
     if (status == kStatus_Success)
     {
         status = FLASH_VerifyErase(&g_flash, adr, g_flash.PFlashSectorSize, kFLASH_marginValueNormal);
     }
+    if (status == kStatus_Success)
+    {
+        FlashTiming_Erased(g_flash.PFlashSectorSize);
+        FlashJournal_Erased(adr);
+    }
+    else
+    {
+        FlashTiming_Stop();
+    }
     return status;
 }
 
@@ -172,7 +199,10 @@ uint32_t EraseSector(uint32_t adr)
  */
 uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
 {
-    int status = FLASH_Program(&g_flash, adr, buf, sz);
+    int status;
+
+    FlashTiming_Start();
+    status = FLASH_Program(&g_flash, adr, buf, sz);
     if (status == kStatus_Success)
     {
         // Must use kFlashMargin_User, or kFlashMargin_Factory for verify program
@@ -180,6 +210,45 @@ uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
                               buf, kFLASH_marginValueUser,
                               NULL, NULL);
     }
+    if (status == kStatus_Success)
+    {
+        FlashTiming_Programmed(sz);
+        FlashJournal_Programmed(adr, sz);
+    }
+    else
+    {
+        FlashTiming_Stop();
+    }
     return status;
 }
 
+/*
+ *  Sector size, used by SurveySectors
+ *    Parameter:      adr:  Sector Address
+ *    Return Value:   Sector Size
+ */
+uint32_t SectorSize(uint32_t adr)
+{
+    return g_flash.PFlashSectorSize;
+}
+
+/*
+ *  Sector state, used by SurveySectors
+ *    Parameter:      adr:  Sector Address
+ *                    sz:   Sector Size
+ *    Return Value:   SECTOR_BLANK, SECTOR_PARTIAL or SECTOR_FULL
+ */
+uint32_t SectorState(uint32_t adr, uint32_t sz)
+{
+    uint32_t state;
+
+    // The controller checks a whole sector in one command
+    if (FLASH_VerifyErase(&g_flash, adr, sz, kFLASH_marginValueNormal) == kStatus_Success)
+    {
+        return SECTOR_BLANK;
+    }
+    // Only read back sectors which need erasing anyway, a sector which
+    // reads erased but fails the margin check still needs an erase
+    state = SectorScan(adr, sz);
+    return (state == SECTOR_BLANK) ? SECTOR_PARTIAL : state;
+}
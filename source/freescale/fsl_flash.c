@@ -29,6 +29,7 @@
  */
 
 #include "fsl_flash.h"
+#include "FlashWait.h"
 
 /*******************************************************************************
  * Definitions
@@ -148,6 +149,8 @@
 #define FTFx_FSTAT_MGSTAT0_MASK FTFA_FSTAT_MGSTAT0_MASK
 #define FTFx_FSEC_SEC_MASK FTFA_FSEC_SEC_MASK
 #define FTFx_FSEC_KEYEN_MASK FTFA_FSEC_KEYEN_MASK
+#define FTFx_FCNFG_CCIE_MASK FTFA_FCNFG_CCIE_MASK
+#define FTFx_COMMAND_COMPLETE_IRQS FTFA_COMMAND_COMPLETE_IRQS
 #if defined(FSL_FEATURE_FLASH_HAS_FLEX_RAM) && FSL_FEATURE_FLASH_HAS_FLEX_RAM
 #define FTFx_FCNFG_RAMRDY_MASK FTFA_FCNFG_RAMRDY_MASK
 #endif /* FSL_FEATURE_FLASH_HAS_FLEX_RAM */
@@ -164,6 +167,8 @@
 #define FTFx_FSTAT_MGSTAT0_MASK FTFE_FSTAT_MGSTAT0_MASK
 #define FTFx_FSEC_SEC_MASK FTFE_FSEC_SEC_MASK
 #define FTFx_FSEC_KEYEN_MASK FTFE_FSEC_KEYEN_MASK
+#define FTFx_FCNFG_CCIE_MASK FTFE_FCNFG_CCIE_MASK
+#define FTFx_COMMAND_COMPLETE_IRQS FTFE_COMMAND_COMPLETE_IRQS
 #if defined(FSL_FEATURE_FLASH_HAS_FLEX_RAM) && FSL_FEATURE_FLASH_HAS_FLEX_RAM
 #define FTFx_FCNFG_RAMRDY_MASK FTFE_FCNFG_RAMRDY_MASK
 #endif /* FSL_FEATURE_FLASH_HAS_FLEX_RAM */
@@ -180,6 +185,8 @@
 #define FTFx_FSTAT_MGSTAT0_MASK FTFL_FSTAT_MGSTAT0_MASK
 #define FTFx_FSEC_SEC_MASK FTFL_FSEC_SEC_MASK
 #define FTFx_FSEC_KEYEN_MASK FTFL_FSEC_KEYEN_MASK
+#define FTFx_FCNFG_CCIE_MASK FTFL_FCNFG_CCIE_MASK
+#define FTFx_COMMAND_COMPLETE_IRQS FTFL_COMMAND_COMPLETE_IRQS
 #if defined(FSL_FEATURE_FLASH_HAS_FLEX_RAM) && FSL_FEATURE_FLASH_HAS_FLEX_RAM
 #define FTFx_FCNFG_RAMRDY_MASK FTFL_FCNFG_RAMRDY_MASK
 #endif /* FSL_FEATURE_FLASH_HAS_FLEX_RAM */
@@ -297,22 +304,22 @@ static status_t flash_check_user_key(uint32_t key);
 
 /*! @brief Access to FTFx->FCCOB */
 #if defined(FSL_FEATURE_FLASH_IS_FTFA) && FSL_FEATURE_FLASH_IS_FTFA
-volatile uint32_t *const kFCCOBx = (volatile uint32_t *)&FTFA->FCCOB3;
+#define kFCCOBx ((volatile uint32_t *)&FTFA->FCCOB3)
 #elif defined(FSL_FEATURE_FLASH_IS_FTFE) && FSL_FEATURE_FLASH_IS_FTFE
-volatile uint32_t *const kFCCOBx = (volatile uint32_t *)&FTFE->FCCOB3;
+#define kFCCOBx ((volatile uint32_t *)&FTFE->FCCOB3)
 #elif defined(FSL_FEATURE_FLASH_IS_FTFL) && FSL_FEATURE_FLASH_IS_FTFL
-volatile uint32_t *const kFCCOBx = (volatile uint32_t *)&FTFL->FCCOB3;
+#define kFCCOBx ((volatile uint32_t *)&FTFL->FCCOB3)
 #else
 #error "Unknown flash controller"
 #endif
 
 /*! @brief Access to FTFx->FPROT */
 #if defined(FSL_FEATURE_FLASH_IS_FTFA) && FSL_FEATURE_FLASH_IS_FTFA
-volatile uint32_t *const kFPROT = (volatile uint32_t *)&FTFA->FPROT3;
+#define kFPROT ((volatile uint32_t *)&FTFA->FPROT3)
 #elif defined(FSL_FEATURE_FLASH_IS_FTFE) && FSL_FEATURE_FLASH_IS_FTFE
-volatile uint32_t *const kFPROT = (volatile uint32_t *)&FTFE->FPROT3;
+#define kFPROT ((volatile uint32_t *)&FTFE->FPROT3)
 #elif defined(FSL_FEATURE_FLASH_IS_FTFL) && FSL_FEATURE_FLASH_IS_FTFL
-volatile uint32_t *const kFPROT = (volatile uint32_t *)&FTFL->FPROT3;
+#define kFPROT ((volatile uint32_t *)&FTFL->FPROT3)
 #else
 #error "Unknown flash controller"
 #endif
@@ -333,6 +340,11 @@ static uint8_t s_flashCacheClearCommand[kFLASH_executeInRamFunctionMaxSize];
 static flash_execute_in_ram_function_config_t s_flashExecuteInRamFunctionInfo;
 #endif
 
+#if !FLASH_DRIVER_IS_FLASH_RESIDENT
+/*! @brief Command complete interrupt of the flash controller, passed to FlashWait_Start() */
+static const IRQn_Type s_ftfxCommandCompleteIrqs[] = FTFx_COMMAND_COMPLETE_IRQS;
+#endif
+
 /*!
  * @brief Table of pflash sizes.
  *
@@ -351,7 +363,7 @@ static flash_execute_in_ram_function_config_t s_flashExecuteInRamFunctionInfo;
  *      flashDensity = ((uint32_t)kPFlashDensities[pfsize]) << 10;
  *  @endcode
  */
-const uint16_t kPFlashDensities[] = {
+static const uint16_t kPFlashDensities[] = {
     8,    /* 0x0 - 8192, 8KB */
     16,   /* 0x1 - 16384, 16KB */
     24,   /* 0x2 - 24576, 24KB */
@@ -1981,11 +1993,23 @@ static status_t flash_command_sequence(flash_config_t *config)
     /* clear CCIF bit */
     FTFx->FSTAT = FTFx_FSTAT_CCIF_MASK;
 
+#if defined(FLASH_WAIT_IRQ)
+    /* raise the command complete interrupt, see FlashWait.h */
+    FTFx->FCNFG |= FTFx_FCNFG_CCIE_MASK;
+#endif
+    FlashWait_Start(s_ftfxCommandCompleteIrqs[0]);
+
     /* Check CCIF bit of the flash status register, wait till it is set.
      * IP team indicates that this loop will always complete. */
     while (!(FTFx->FSTAT & FTFx_FSTAT_CCIF_MASK))
     {
+        FlashWait_Idle();
     }
+
+#if defined(FLASH_WAIT_IRQ)
+    FTFx->FCNFG &= ~FTFx_FCNFG_CCIE_MASK;
+#endif
+    FlashWait_Stop();
 #endif /* FLASH_DRIVER_IS_FLASH_RESIDENT */
 
     /* Check error bits */
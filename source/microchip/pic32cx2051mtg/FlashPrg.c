@@ -15,7 +15,8 @@
  */
 
 #include "FlashOS.H"        // FlashOS Structures
-#include "flashd.h"
+#include "FlashTiming.h"
+#include "chip.h"
 #include "string.h"
 
 /* Flash Boot mode bits for GPNMV : 0x60 */
@@ -25,6 +26,9 @@
 /* Bank selection bit for GPNMV */
 #define GPNVM_BANK_SELECTION_BIT 1
 
+/* Each of SEFC0 and SEFC1 serves one half of the flash */
+#define FLASH_PLANE_SIZE         (IFLASH_SIZE / 2)
+
 static uint32_t dev_base_adr = 0;
 
 uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
@@ -32,6 +36,8 @@ uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
 	uint32_t ret;
 	
 	FLASHD_Initialize(0, 0); // do not use IAP, Mistral
+	FLASHD_SetOverlapped(1); // EraseChip runs SEFC0 and SEFC1 concurrently,
+	                         // other calls complete their own command
 	
 	ret = FLASHD_SetGPNVM(GPNVM_BOOT_MODE_BIT0);
 	ret = FLASHD_SetGPNVM(GPNVM_BOOT_MODE_BIT1);
@@ -53,6 +59,11 @@ uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
  */
 uint32_t UnInit(uint32_t fnc)
 {
+	// Collect the status of the last erase or write
+	if (FLASHD_Sync() != 0) {
+		return (1);
+	}
+
 	return (0);
 }
 
@@ -62,7 +73,26 @@ uint32_t UnInit(uint32_t fnc)
  */
 uint32_t EraseChip(void)
 {
-	return FLASHD_Erase(dev_base_adr);
+	FlashTiming_Start();
+
+	// Erase both planes concurrently
+	if (FLASHD_Erase(dev_base_adr) != 0) {
+		FlashTiming_Stop();
+		return (1);
+	}
+
+	if (FLASHD_Erase(dev_base_adr + FLASH_PLANE_SIZE) != 0) {
+		FlashTiming_Stop();
+		return (1);
+	}
+
+	if (FLASHD_Sync() != 0) {
+		FlashTiming_Stop();
+		return (1);
+	}
+
+	FlashTiming_Erased(FLASH_TIMING_CHIP);
+	return (0);
 }
 
 /*
@@ -82,10 +112,20 @@ uint32_t EraseSector(uint32_t adr)
 		return (1);
 	}
 	
+	FlashTiming_Start();
 	if (FLASHD_EraseSector(adr) != 0) {
+		FlashTiming_Stop();
+		return (1);
+	}
+
+	// Complete the erase, the host may read the sector as soon as this
+	// returns and an error must not be reported by the next call
+	if (FLASHD_SyncAddress(startAddr) != 0) {
+		FlashTiming_Stop();
 		return (1);
 	}
 	
+	FlashTiming_Erased(IFLASH_SECTOR_SIZE);
 	return (0);
 }
 
@@ -102,11 +142,22 @@ uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
 
 	startAddr = adr & 0x01FFFFFF;
 
+	FlashTiming_Start();
+
 	// Write data
 	if (FLASHD_Write((unsigned int)startAddr, buf, sz) != 0) {
+		FlashTiming_Stop();
 		return (1);
 	}
 
+	// Complete the write, an error must be reported for this page and
+	// not by the next call to the plane
+	if (FLASHD_SyncAddress(startAddr) != 0) {
+		FlashTiming_Stop();
+		return (1);
+	}
+
+	FlashTiming_Programmed(sz);
 	return (0);
 }
 
@@ -121,6 +172,10 @@ unsigned long Verify (unsigned long adr, unsigned long sz, unsigned char *buf)
 {
 	uint8_t *puc_flash_data;
 	
+	if (FLASHD_Sync() != 0) {
+		return (adr);
+	}
+
 	puc_flash_data = (uint8_t *)adr;
 	
 	if (memcmp(puc_flash_data, buf, sz) == 0) {
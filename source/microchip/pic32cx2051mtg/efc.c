@@ -73,11 +73,17 @@
  *        Headers
  *----------------------------------------------------------------------------*/
 #include "chip.h"
+#include "FlashWait.h"
 
 #include <assert.h>
 
 #define EEFC_FCR_FCMD(value) ((EEFC_FCR_FCMD_Msk & ((value) << EEFC_FCR_FCMD_Pos)))
 
+/* SEFC_WaitCommand polls FRDY and never raises the flash ready interrupt */
+#if defined(FLASH_WAIT_IRQ)
+#error "FLASH_WAIT_IRQ is not supported by the SEFC driver"
+#endif
+
 
 /*----------------------------------------------------------------------------
  *        Exported functions
@@ -245,8 +251,8 @@ extern uint32_t SEFC_PerformCommand( Sefc* sefc, uint32_t dwCommand, uint32_t dw
 {
     if ( dwUseIAP != 0 )
     {
-        /* Pointer on IAP function in ROM */
-        static uint32_t (*IAP_PerformCommand)( uint32_t, uint32_t ) ;
+        /* Pointer on IAP function in ROM, kept on the stack rather than in RW data */
+        uint32_t (*IAP_PerformCommand)( uint32_t, uint32_t ) ;
 
         IAP_PerformCommand = (uint32_t (*)( uint32_t, uint32_t )) *((uint32_t*)CHIP_FLASH_IAP_ADDRESS ) ;
         if (sefc == SEFC0) {
@@ -261,16 +267,51 @@ extern uint32_t SEFC_PerformCommand( Sefc* sefc, uint32_t dwCommand, uint32_t dw
     }
     else
     {
-        uint32_t dwStatus ;
+        SEFC_StartCommand( sefc, dwCommand, dwArgument ) ;
+
+        return SEFC_WaitCommand( sefc ) ;
+    }
+}
+
+/**
+ * \brief Starts the given command without waiting for its completion.
+ *
+ * \note The command must be completed with SEFC_WaitCommand() before another
+ * command is issued to, or the latch buffer is written on, the same controller.
+ * The other controller stays available in the meantime.
+ *
+ * \param sefc  Pointer to a Efc instance
+ * \param command  Command to perform.
+ * \param argument  Optional command argument.
+ */
+extern void SEFC_StartCommand( Sefc* sefc, uint32_t dwCommand, uint32_t dwArgument )
+{
+    sefc->EEFC_FCR = EEFC_FCR_FKEY_PASSWD | EEFC_FCR_FARG(dwArgument) | EEFC_FCR_FCMD(dwCommand) ;
+}
 
-        sefc->EEFC_FCR = EEFC_FCR_FKEY_PASSWD | EEFC_FCR_FARG(dwArgument) | EEFC_FCR_FCMD(dwCommand) ;
-        do
+/**
+ * \brief Waits until the command in progress on the EEFC completes.
+ *
+ * \param sefc  Pointer to a Efc instance
+ *
+ * \return 0 if successful, otherwise returns an error code.
+ */
+extern uint32_t SEFC_WaitCommand( Sefc* sefc )
+{
+    uint32_t dwStatus ;
+
+    FlashWait_Start( 0 ) ;
+    do
+    {
+        dwStatus = sefc->EEFC_FSR ;
+        if ( (dwStatus & EEFC_FSR_FRDY) != EEFC_FSR_FRDY )
         {
-            dwStatus = sefc->EEFC_FSR ;
+            FlashWait_Idle() ;
         }
-        while ( (dwStatus & EEFC_FSR_FRDY) != EEFC_FSR_FRDY ) ;
-
-        return ( dwStatus & (EEFC_FSR_FLOCKE | EEFC_FSR_FCMDE | EEFC_FSR_FLERR) ) ;
     }
+    while ( (dwStatus & EEFC_FSR_FRDY) != EEFC_FSR_FRDY ) ;
+    FlashWait_Stop() ;
+
+    return ( dwStatus & (EEFC_FSR_FLOCKE | EEFC_FSR_FCMDE | EEFC_FSR_FLERR) ) ;
 }
 
@@ -43,6 +43,8 @@
  * -# Computes the address of a %flash access given the EFC, page and offset
  *    for difference density %flash memory using SEFC_ComputeAddress().
  * -# Start the executing command with SEFC_PerformCommand()
+ * -# Overlap commands on the two controllers with SEFC_StartCommand() and
+ *    SEFC_WaitCommand()
  * -# Retrieve the current status of the EFC using SEFC_GetStatus().
  * -# Retrieve the result of the last executed command with SEFC_GetResult().
  */
@@ -75,6 +77,11 @@
   #define IFLASH_NB_OF_LOCK_BITS  256u
 #endif
 
+/* Second controller, serving the upper half of the flash */
+#if defined(SEFC1) && !defined(EFC1)
+  #define EFC1 SEFC1
+#endif
+
 /* EFC command */
 #define SEFC_FCMD_GETD    0x00 /* Get Flash Descriptor */
 #define SEFC_FCMD_WP      0x01 /* Write page */
@@ -119,6 +126,10 @@ extern void SEFC_ComputeAddress( Sefc* sefc, uint16_t wPage, uint16_t wOffset, u
 
 extern uint32_t SEFC_PerformCommand( Sefc* sefc, uint32_t dwCommand, uint32_t dwArgument, uint32_t dwUseIAP ) ;
 
+extern void SEFC_StartCommand( Sefc* sefc, uint32_t dwCommand, uint32_t dwArgument ) ;
+
+extern uint32_t SEFC_WaitCommand( Sefc* sefc ) ;
+
 extern uint32_t SEFC_GetStatus( Sefc* sefc ) ;
 
 extern uint32_t SEFC_GetResult( Sefc* sefc ) ;
@@ -95,6 +95,8 @@
 
 static uint32_t _pdwPageBuffer[IFLASH_PAGE_SIZE/sizeof(uint32_t)] ;
 static uint32_t _dwUseIAP = 1; /* Not Use IAP interface by default. */
+static uint32_t _dwOverlapped = 0; /* Wait for every command by default. */
+static uint32_t _dwPendingMask = 0; /* Controllers with a command in flight. */
 
 /*----------------------------------------------------------------------------
  *        Local macros
@@ -106,6 +108,94 @@ static uint32_t _dwUseIAP = 1; /* Not Use IAP interface by default. */
  *        Local functions
  *----------------------------------------------------------------------------*/
 
+/**
+ * \brief Returns the pending mask bit of the given controller.
+ *
+ * \param pSefc  Pointer to a Efc instance
+ */
+static uint32_t GetPendingBit( Sefc* pSefc )
+{
+#if defined (EFC1)
+    return (pSefc == EFC1) ? 2u : 1u ;
+#else
+    pSefc = pSefc ; /* avoid warnings */
+    return 1u ;
+#endif
+}
+
+/**
+ * \brief Completes the command left in flight on the given controller, if any.
+ *
+ * \param pSefc  Pointer to a Efc instance
+ * \return 0 if successful, otherwise returns the error code of that command.
+ */
+static uint32_t WaitPending( Sefc* pSefc )
+{
+    uint32_t dwBit = GetPendingBit( pSefc ) ;
+
+    if ( (_dwPendingMask & dwBit) == 0 )
+    {
+        return 0 ;
+    }
+    _dwPendingMask &= ~dwBit ;
+
+    return SEFC_WaitCommand( pSefc ) ;
+}
+
+/**
+ * \brief Performs the given command and waits for its completion.
+ *
+ * \param pSefc  Pointer to a Efc instance
+ * \param dwCommand  Command to perform.
+ * \param dwArgument  Optional command argument.
+ * \return 0 if successful, otherwise returns an error code.
+ */
+static uint32_t PerformCommand( Sefc* pSefc, uint32_t dwCommand, uint32_t dwArgument )
+{
+    uint32_t dwError ;
+
+    dwError = WaitPending( pSefc ) ;
+    if ( dwError )
+    {
+        return dwError ;
+    }
+
+    return SEFC_PerformCommand( pSefc, dwCommand, dwArgument, _dwUseIAP ) ;
+}
+
+/**
+ * \brief Starts the given erase or write command.
+ *
+ * \note In overlapped mode the command is left in flight so the other
+ * controller can be used meanwhile; its status is collected by the next
+ * access to the same controller or by FLASHD_Sync().
+ *
+ * \param pSefc  Pointer to a Efc instance
+ * \param dwCommand  Command to perform.
+ * \param dwArgument  Optional command argument.
+ * \return 0 if successful, otherwise returns an error code.
+ */
+static uint32_t StartCommand( Sefc* pSefc, uint32_t dwCommand, uint32_t dwArgument )
+{
+    uint32_t dwError ;
+
+    if ( (_dwOverlapped == 0) || (_dwUseIAP != 0) )
+    {
+        return PerformCommand( pSefc, dwCommand, dwArgument ) ;
+    }
+
+    dwError = WaitPending( pSefc ) ;
+    if ( dwError )
+    {
+        return dwError ;
+    }
+
+    SEFC_StartCommand( pSefc, dwCommand, dwArgument ) ;
+    _dwPendingMask |= GetPendingBit( pSefc ) ;
+
+    return 0 ;
+}
+
 
 /**
  * \brief Computes the lock range associated with the given address range.
@@ -165,6 +255,62 @@ extern void FLASHD_Initialize( uint32_t dwMCk, uint32_t dwUseIAP )
     SEFC_DisableFrdyIt( EFC1 ) ;
 #endif
     _dwUseIAP = dwUseIAP ;
+    _dwPendingMask = 0 ;
+}
+
+/**
+ * \brief Selects whether erase and write commands are overlapped.
+ *
+ * When enabled, FLASHD_Erase(), FLASHD_EraseSector() and FLASHD_Write() return
+ * as soon as the last command is started, so that a command on the other
+ * controller can run concurrently. FLASHD_Sync() must be called before the
+ * flash is read back.
+ *
+ * \param dwOverlapped  0: wait for every command, 1: overlap commands.
+ */
+extern void FLASHD_SetOverlapped( uint32_t dwOverlapped )
+{
+    _dwOverlapped = dwOverlapped ;
+}
+
+/**
+ * \brief Waits for the commands in flight on all controllers.
+ *
+ * \return 0 if successful, otherwise returns the first error code.
+ */
+extern uint32_t FLASHD_Sync( void )
+{
+    uint32_t dwError ;
+
+    dwError = WaitPending( SEFC0 ) ;
+#if defined (EFC1)
+    if ( dwError == 0 )
+    {
+        dwError = WaitPending( EFC1 ) ;
+    }
+    else
+    {
+        WaitPending( EFC1 ) ;
+    }
+#endif
+
+    return dwError ;
+}
+
+/**
+ * \brief Waits for the command in flight on the controller serving an address.
+ *
+ * \param dwAddress  Address served by the controller.
+ * \return 0 if successful, otherwise returns the error code of that command.
+ */
+extern uint32_t FLASHD_SyncAddress( uint32_t dwAddress )
+{
+    Sefc* pSefc ;
+    uint16_t wPage ;
+
+    SEFC_TranslateAddress( &pSefc, dwAddress, &wPage, 0 ) ;
+
+    return WaitPending( pSefc ) ;
 }
 
 /**
@@ -184,7 +330,7 @@ extern uint32_t FLASHD_Erase( uint32_t dwAddress )
 
     /* Translate write address */
     SEFC_TranslateAddress( &pSefc, dwAddress, &wPage, &wOffset ) ;
-    dwError = SEFC_PerformCommand( pSefc, SEFC_FCMD_EA, 0, _dwUseIAP ) ;
+    dwError = StartCommand( pSefc, SEFC_FCMD_EA, 0 ) ;
 
     return dwError ;
 }
@@ -207,7 +353,7 @@ extern uint32_t FLASHD_EraseSector( uint32_t dwAddress )
 
     /* Translate write address */
     SEFC_TranslateAddress( &pSefc, dwAddress, &wPage, &wOffset ) ;
-    dwError = SEFC_PerformCommand( pSefc, SEFC_FCMD_ES, wPage, _dwUseIAP ) ;
+    dwError = StartCommand( pSefc, SEFC_FCMD_ES, wPage ) ;
 
     return dwError ;
 }
@@ -289,6 +435,7 @@ extern uint32_t FLASHD_Write( uint32_t dwAddress, const void *pvBuffer, uint32_t
     uint32_t dwError ;
     uint32_t dwIdx ;
     uint32_t *pAlignedDestination ;
+    const uint32_t *pdwPageBuffer = _pdwPageBuffer;
     uint8_t  *pucPageBuffer = (uint8_t *)_pdwPageBuffer;
 
     assert( pvBuffer ) ;
@@ -301,6 +448,13 @@ extern uint32_t FLASHD_Write( uint32_t dwAddress, const void *pvBuffer, uint32_t
     /* Write all pages */
     while ( dwSize > 0 )
     {
+        /* The page and latch buffer of a busy controller cannot be accessed */
+        dwError = WaitPending( pSefc ) ;
+        if ( dwError )
+        {
+            return dwError ;
+        }
+
         /* Copy data in temporary buffer to avoid alignment problems */
         writeSize = min((uint32_t)IFLASH_PAGE_SIZE - offset, dwSize ) ;
         SEFC_ComputeAddress(pSefc, page, 0, &pageAddress ) ;
@@ -324,7 +478,7 @@ extern uint32_t FLASHD_Write( uint32_t dwAddress, const void *pvBuffer, uint32_t
          */
         pAlignedDestination = (uint32_t*)pageAddress ;
         for (dwIdx = 0; dwIdx < (IFLASH_PAGE_SIZE / sizeof(uint32_t)); ++ dwIdx) {
-            *pAlignedDestination++ = _pdwPageBuffer[dwIdx];
+            *pAlignedDestination++ = pdwPageBuffer[dwIdx];
         }
 
         /* Note for sam3s16 and sam4s:
@@ -333,7 +487,7 @@ extern uint32_t FLASHD_Write( uint32_t dwAddress, const void *pvBuffer, uint32_t
          * block, Erase them first then use Write page command.
          */
         /* Send writing command */
-        dwError = SEFC_PerformCommand( pSefc, SEFC_FCMD_WP, page, _dwUseIAP ) ;
+        dwError = StartCommand( pSefc, SEFC_FCMD_WP, page ) ;
         if ( dwError )
         {
             return dwError ;
@@ -384,7 +538,7 @@ extern uint32_t FLASHD_Lock( uint32_t start, uint32_t end, uint32_t *pActualStar
     /* Lock all pages */
     while ( startPage < endPage )
     {
-        dwError = SEFC_PerformCommand( pSefc, SEFC_FCMD_SLB, startPage, _dwUseIAP ) ;
+        dwError = PerformCommand( pSefc, SEFC_FCMD_SLB, startPage ) ;
         if ( dwError )
         {
             return dwError ;
@@ -430,7 +584,7 @@ extern uint32_t FLASHD_Unlock( uint32_t start, uint32_t end, uint32_t *pActualSt
     /* Unlock all pages */
     while ( startPage < endPage )
     {
-        dwError = SEFC_PerformCommand( pSefc, SEFC_FCMD_CLB, startPage, _dwUseIAP ) ;
+        dwError = PerformCommand( pSefc, SEFC_FCMD_CLB, startPage ) ;
         if ( dwError )
         {
             return dwError ;
@@ -473,7 +627,7 @@ extern uint32_t FLASHD_IsLocked( uint32_t start, uint32_t end )
     }
 
     /* Retrieve lock status */
-    SEFC_PerformCommand( pSefc, SEFC_FCMD_GLB, 0, _dwUseIAP ) ;
+    PerformCommand( pSefc, SEFC_FCMD_GLB, 0 ) ;
     for (i = 0; i < (IFLASH_NB_OF_LOCK_BITS / 32u); i++)
     {
         status[i] = SEFC_GetResult( pSefc ) ;
@@ -507,7 +661,7 @@ extern uint32_t FLASHD_IsGPNVMSet( uint16_t usGPVM )
     assert(usGPVM < GPNVM_NUM_MAX);
 
     /* Get GPNVMs status */
-    SEFC_PerformCommand( SEFC0, SEFC_FCMD_GGPB, 0, _dwUseIAP ) ;
+    PerformCommand( SEFC0, SEFC_FCMD_GGPB, 0 ) ;
     dwStatus = SEFC_GetResult( SEFC0 ) ;
 
     /* Check if GPNVM is set */
@@ -533,7 +687,7 @@ extern uint32_t FLASHD_SetGPNVM( uint16_t usGPVM )
     
     if ( !FLASHD_IsGPNVMSet( usGPVM ) )
     {
-        return SEFC_PerformCommand( SEFC0, SEFC_FCMD_SGPB, usGPVM, _dwUseIAP ) ;
+        return PerformCommand( SEFC0, SEFC_FCMD_SGPB, usGPVM ) ;
     }
     else
     {
@@ -553,7 +707,7 @@ extern uint32_t FLASHD_ClearGPNVM( uint16_t usGPVM )
     
     if ( FLASHD_IsGPNVMSet( usGPVM ) )
     {
-        return SEFC_PerformCommand( SEFC0, SEFC_FCMD_CGPB, usGPVM, _dwUseIAP ) ;
+        return PerformCommand( SEFC0, SEFC_FCMD_CGPB, usGPVM ) ;
     }
     else
     {
@@ -579,6 +733,8 @@ uint32_t FLASHD_ReadUniqueID( uint32_t* pdwUniqueID )
         return 1;
     }
 
+    WaitPending( SEFC0 ) ;
+
     pdwUniqueID[0] = 0 ;
     pdwUniqueID[1] = 0 ;
     pdwUniqueID[2] = 0 ;
@@ -620,6 +776,7 @@ uint32_t FLASHD_ReadUniqueID( uint32_t* pdwUniqueID )
 
 uint32_t FLASHD_GetDescriptor( uint32_t* pdwDescriptor )
 {
+	WaitPending( SEFC0 );
 	while (!(SEFC0->EEFC_FSR & EEFC_FSR_FRDY));  //Flash Ready Status
 	SEFC0->EEFC_FCR = EEFC_FCR_FCMD(EEFC_FCR_FCMD_GETD) | EEFC_FCR_FARG(0) | EEFC_FCR_FKEY_PASSWD;
 	while (!(SEFC0->EEFC_FSR & EEFC_FSR_FRDY));  //Flash Ready Status
@@ -49,6 +49,12 @@
 
 extern void FLASHD_Initialize( uint32_t dwMCk, uint32_t dwUseIAP ) ;
 
+extern void FLASHD_SetOverlapped( uint32_t dwOverlapped ) ;
+
+extern uint32_t FLASHD_Sync( void ) ;
+
+extern uint32_t FLASHD_SyncAddress( uint32_t dwAddress ) ;
+
 extern uint32_t FLASHD_Erase( uint32_t dwAddress ) ;
 
 extern uint32_t FLASHD_EraseSector( uint32_t dwAddress ) ;
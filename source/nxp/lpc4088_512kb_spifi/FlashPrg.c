@@ -15,6 +15,7 @@
  */
 
 #include "FlashOS.H"        // FlashOS Structures
+#include "FlashSparse.h"
 
 // Memory Mapping Control
 #define MEMMAP   (*((volatile unsigned char *) 0x400FC040))
@@ -186,12 +187,16 @@ static int saveInSpifi(uint32_t adr, uint32_t sz, uint8_t* buf)
 
     while (left > 0) {
         uint32_t chunk = (left > 256) ? 256 : left;
-
-        opers.length = chunk;
-        opers.dest = (char *)(adr + off);
-        rc = spifi->spifi_program(&obj, (char*)(buf+off), &opers);
-        if (rc) {
-            return 1;
+        uint32_t ofs, len;
+
+        /* Erased bytes are skipped, see FlashSparse.h */
+        for (ofs = 0; (len = FlashSparse_NextRun(buf + off, chunk, &ofs)) != 0; ofs += len) {
+            opers.length = len;
+            opers.dest = (char *)(adr + off + ofs);
+            rc = spifi->spifi_program(&obj, (char*)(buf + off + ofs), &opers);
+            if (rc) {
+                return 1;
+            }
         }
         off += chunk;
         left -= chunk;
@@ -15,10 +15,15 @@
  */
 
 #include "FlashOS.H"        // FlashOS Structures
+#include "FlashSfdp.h"
+#include "FlashSparse.h"
+#include "FlashTiming.h"
+#include "FlashWait.h"
 #include "fsl_spifi.h"
 #include "string.h"
 
 #define PAGE_SIZE       (256)
+#define SECTOR_SIZE     (4096)
 
 #define COMMAND_NUM     (7)
 #define READ            (0)
@@ -29,7 +34,6 @@
 #define WRITE_REGISTER  (5)
 #define ERASE_CHIP      (6)
 
-#define QUAD_MODE_VAL   0x02
 
 #define SPI_BAUDRATE    24000000
 
@@ -51,6 +55,9 @@
 #define IOCON_PIO_OPENDRAIN_DI      0x00u   /* Open drain is disabled */
 
 
+/* Set when discover switched the device to 4 byte addresses */
+static uint8_t four_byte_mode;
+
 spifi_command_t command[COMMAND_NUM] = {
     {PAGE_SIZE, false, kSPIFI_DataInput, 1, kSPIFI_CommandDataQuad, kSPIFI_CommandOpcodeAddrThreeBytes, 0x6B},
     {PAGE_SIZE, false, kSPIFI_DataOutput, 0, kSPIFI_CommandDataQuad, kSPIFI_CommandOpcodeAddrThreeBytes, 0x32},
@@ -72,22 +79,143 @@ void check_if_finish()
         {
         }
         val = SPIFI_ReadDataByte(SPIFI0);
+        if (val & 0x1)
+        {
+            /* Every poll is a status command on the SPI bus */
+            FlashWait_Idle();
+        }
     } while (val & 0x1);
 }
 
-void enable_quad_mode()
+uint8_t read_status()
+{
+    SPIFI_SetCommand(SPIFI0, &command[GET_STATUS]);
+    while ((SPIFI0->STAT & SPIFI_STAT_INTRQ_MASK) == 0U)
+    {
+    }
+    return SPIFI_ReadDataByte(SPIFI0);
+}
+
+void write_register(uint8_t opcode, const uint8_t *val, uint16_t len)
 {
+    uint16_t i;
+
     /* Write enable */
     SPIFI_SetCommand(SPIFI0, &command[WRITE_ENABLE]);
 
     /* Set write register command */
+    command[WRITE_REGISTER].opcode = opcode;
+    command[WRITE_REGISTER].dataLen = len;
     SPIFI_SetCommand(SPIFI0, &command[WRITE_REGISTER]);
 
-    SPIFI_WriteDataByte(SPIFI0, QUAD_MODE_VAL);
+    for (i = 0; i < len; i++)
+    {
+        SPIFI_WriteDataByte(SPIFI0, val[i]);
+    }
 
     check_if_finish();
 }
 
+void enable_quad_mode(uint8_t qer)
+{
+    uint8_t val[2];
+
+    switch (qer)
+    {
+        case SFDP_QER_NONE:
+            break;
+        case SFDP_QER_SR1_BIT6:
+            val[0] = read_status() | 0x40;
+            write_register(0x01, val, 1);
+            break;
+        case SFDP_QER_SR2_BIT1:
+        case SFDP_QER_SR2_BIT1_A:
+        case SFDP_QER_SR2_BIT1_B:
+            val[0] = read_status();
+            val[1] = 0x02;
+            write_register(0x01, val, 2);
+            break;
+        case SFDP_QER_SR2_BIT7:
+            val[0] = 0x80;
+            write_register(0x3E, val, 1);
+            break;
+        default:
+            val[0] = 0x02;
+            write_register(0x31, val, 1);
+            break;
+    }
+}
+
+uint32_t sfdp_read(uint32_t adr, uint32_t sz, uint8_t *buf)
+{
+    spifi_command_t sfdp = {0, false, kSPIFI_DataInput, SFDP_READ_DUMMY / 8, kSPIFI_CommandAllSerial,
+                            kSPIFI_CommandOpcodeAddrThreeBytes, SFDP_READ_CMD};
+    uint32_t i;
+
+    sfdp.dataLen = sz;
+    SPIFI_ResetCommand(SPIFI0);
+    SPIFI_SetCommandAddress(SPIFI0, adr);
+    SPIFI_SetCommand(SPIFI0, &sfdp);
+    for (i = 0; i < sz; i++)
+    {
+        buf[i] = SPIFI_ReadDataByte(SPIFI0);
+    }
+    return 0;
+}
+
+/*
+ *  Adapt the command table to the device, devices without SFDP keep the
+ *  4KB sector erase and the 0x31 quad enable
+ *    Return Value:   0 - OK,  1 - Failed
+ */
+uint32_t discover()
+{
+    sfdp_info_t info = {0};
+    uint8_t opcode = command[ERASE_SECTOR].opcode;
+    uint8_t val[1] = {0};
+
+    info.page_size = PAGE_SIZE;
+    info.addr_bytes = 3;
+    info.quad_enable = SFDP_QER_SR2_BIT1_C;
+    if (Sfdp_Parse(sfdp_read, &info) == 0)
+    {
+        /* Sectors must be erased with a single command */
+        if (Sfdp_EraseSize(&info, SECTOR_SIZE, &opcode) != SECTOR_SIZE)
+        {
+            return 1;
+        }
+        /* A smaller page would wrap within ProgramPage */
+        if (info.page_size < PAGE_SIZE)
+        {
+            return 1;
+        }
+    }
+    command[ERASE_SECTOR].opcode = opcode;
+
+    four_byte_mode = 0;
+    if (info.addr_bytes == 4)
+    {
+        /* Devices supporting both widths have to be switched, 0xB7 with or
+           without write enable, write_register always sends it. Other
+           methods are not supported. */
+        if (info.enter_4byte & (SFDP_4B_ENTER_B7 | SFDP_4B_ENTER_WREN_B7))
+        {
+            write_register(0xB7, val, 0);
+            four_byte_mode = 1;
+        }
+        else if (!(info.enter_4byte & SFDP_4B_ALWAYS))
+        {
+            return 1;
+        }
+        command[READ].type = kSPIFI_CommandOpcodeAddrFourBytes;
+        command[PROGRAM_PAGE].type = kSPIFI_CommandOpcodeAddrFourBytes;
+        command[ERASE_SECTOR].type = kSPIFI_CommandOpcodeAddrFourBytes;
+    }
+
+    enable_quad_mode(info.quad_enable);
+    return 0;
+}
+
 /* Get HF FRO Clk */
 /*! brief	Return Frequency of High-Freq output of FRO
  *  return	Frequency of High-Freq output of FRO
@@ -140,9 +268,7 @@ uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
     SPIFI_GetDefaultConfig(&config);
     SPIFI_Init(SPIFI0, &config);
 
-    enable_quad_mode();
-
-    return (0);
+    return discover();
 }
 
 
@@ -153,6 +279,15 @@ uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
  */
 uint32_t UnInit(uint32_t fnc)
 {
+    uint8_t val[1] = {0};
+
+    /* Leave the device in 3 byte address mode for the boot ROM */
+    if (four_byte_mode)
+    {
+        SPIFI_ResetCommand(SPIFI0);
+        write_register(0xE9, val, 0);
+        four_byte_mode = 0;
+    }
     return (0);
 }
 
@@ -162,6 +297,8 @@ uint32_t UnInit(uint32_t fnc)
  */
 uint32_t EraseChip(void)
 {
+    FlashTiming_Start();
+
     /* Reset the SPIFI to switch to command mode */
     SPIFI_ResetCommand(SPIFI0);
 
@@ -176,6 +313,7 @@ uint32_t EraseChip(void)
     /* Check if finished */
     check_if_finish();
 
+    FlashTiming_Erased(FLASH_TIMING_CHIP);
     return 0;
 }
 
@@ -186,6 +324,8 @@ uint32_t EraseChip(void)
  */
 uint32_t EraseSector(uint32_t adr)
 {
+    FlashTiming_Start();
+
     /* Reset the SPIFI to switch to command mode */
     SPIFI_ResetCommand(SPIFI0);
 
@@ -198,6 +338,7 @@ uint32_t EraseSector(uint32_t adr)
     /* Check if finished */
     check_if_finish();
 
+    FlashTiming_Erased(SECTOR_SIZE);
     return 0;
 }
 
@@ -211,20 +352,29 @@ uint32_t EraseSector(uint32_t adr)
 uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
 {
     uint32_t i = 0;
+    uint32_t ofs, len;
+
+    FlashTiming_Start();
 
     /* Reset the SPIFI to switch to command mode */
     SPIFI_ResetCommand(SPIFI0);
 
-    SPIFI_SetCommand(SPIFI0, &command[WRITE_ENABLE]);
-    SPIFI_SetCommandAddress(SPIFI0, (adr - FSL_FEATURE_SPIFI_START_ADDR));
-    SPIFI_SetCommand(SPIFI0, &command[PROGRAM_PAGE]);
-
-    for (i = 0; i < PAGE_SIZE; i += 4, buf++)
+    /* Erased bytes are skipped, see FlashSparse.h */
+    for (ofs = 0; (len = FlashSparse_NextRun((uint8_t *)buf, PAGE_SIZE, &ofs)) != 0; ofs += len)
     {
-        SPIFI_WriteData(SPIFI0, *buf);
-    }
+        SPIFI_SetCommand(SPIFI0, &command[WRITE_ENABLE]);
+        SPIFI_SetCommandAddress(SPIFI0, (adr + ofs - FSL_FEATURE_SPIFI_START_ADDR));
+        command[PROGRAM_PAGE].dataLen = len;
+        SPIFI_SetCommand(SPIFI0, &command[PROGRAM_PAGE]);
 
-    check_if_finish();
+        for (i = 0; i < len; i += 4)
+        {
+            SPIFI_WriteData(SPIFI0, buf[(ofs + i) / 4]);
+        }
+
+        check_if_finish();
+    }
 
+    FlashTiming_Programmed(sz);
     return 0;
 }
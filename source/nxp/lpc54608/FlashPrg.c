@@ -15,6 +15,7 @@
  */
 
 #include "FlashOS.H"        // FlashOS Structures
+#include "FlashPrg.h"
 #include "fsl_flashiap.h"
 #include "fsl_power.h"
 #include "string.h"
@@ -124,3 +125,31 @@ uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
     }
     return status;
 }
+
+/*
+ *  Sector size, used by SurveySectors
+ *    Parameter:      adr:  Sector Address
+ *    Return Value:   Sector Size
+ */
+uint32_t SectorSize(uint32_t adr)
+{
+    return FSL_FEATURE_SYSCON_FLASH_SECTOR_SIZE_BYTES;
+}
+
+/*
+ *  Sector state, used by SurveySectors
+ *    Parameter:      adr:  Sector Address
+ *                    sz:   Sector Size
+ *    Return Value:   SECTOR_BLANK, SECTOR_PARTIAL or SECTOR_FULL
+ */
+uint32_t SectorState(uint32_t adr, uint32_t sz)
+{
+    uint32_t n = adr / FSL_FEATURE_SYSCON_FLASH_SECTOR_SIZE_BYTES;   // Get Sector Number
+
+    // IAP blank check sector (command 53)
+    if (FLASHIAP_BlankCheckSector(n, n) == kStatus_Success)
+    {
+        return SECTOR_BLANK;
+    }
+    return SectorScan(adr, sz);
+}
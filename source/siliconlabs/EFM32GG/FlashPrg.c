@@ -18,6 +18,8 @@
 
 #include "FlashOS.h"        /* FlashOS Structures */
 #include "FlashPrg.h"
+#include "FlashTiming.h"
+#include "FlashWait.h"
 
 /* Defines required by em_msc */
 #include "core_cm3.h"
@@ -48,7 +50,9 @@
 static msc_Return_TypeDef MscStatusWait( uint32_t mask, uint32_t value )
 {
   uint32_t status;
-  int timeOut = MSC_PROGRAM_TIMEOUT;
+  /* Busy waits are paced, keep the timeout about the same length */
+  int timeOut = ( mask == MSC_STATUS_BUSY ) ? MSC_PROGRAM_TIMEOUT / FLASH_WAIT_PACE
+                                            : MSC_PROGRAM_TIMEOUT;
 
   while (1)
   {
@@ -71,6 +75,10 @@ static msc_Return_TypeDef MscStatusWait( uint32_t mask, uint32_t value )
     if ( ( status & mask ) == value )
       return mscReturnOk;
 
+    /* Erases and writes take long, leave the bus to the MSC between polls */
+    if ( mask == MSC_STATUS_BUSY )
+      FlashWait_Idle();
+
     timeOut--;
     if ( timeOut == 0 )
       break;
@@ -155,6 +163,7 @@ uint32_t EraseChip(void)
 {
   msc_Return_TypeDef result;
 
+  FlashTiming_Start();
   MSC->WRITECTRL |= MSC_WRITECTRL_WREN;
   MSC->MASSLOCK   = MSC_MASSLOCK_LOCKKEY_UNLOCK;
 
@@ -163,6 +172,11 @@ uint32_t EraseChip(void)
   MSC->MASSLOCK   = 0;
   MSC->WRITECTRL &= ~MSC_WRITECTRL_WREN;
 
+  if ( result == mscReturnOk )
+    FlashTiming_Erased( FLASH_TIMING_CHIP );
+  else
+    FlashTiming_Stop();
+
   return result == mscReturnOk ? 0 : 1;
 }
 
@@ -184,26 +198,26 @@ uint32_t EraseSector(uint32_t adr)
     pageSize -= 4;
   } while ( pageSize && ( blank == 0xFFFFFFFF ) );
 
+  /* Blank pages are skipped and not timed */
   if ( blank != 0xFFFFFFFF )
   {
+    FlashTiming_Start();
     MSC->WRITECTRL |= MSC_WRITECTRL_WREN;
     MSC->ADDRB      = adr;
     MSC->WRITECMD   = MSC_WRITECMD_LADDRIM;
     result          = DoFlashCmd( MSC_WRITECMD_ERASEPAGE );
     MSC->WRITECTRL &= ~MSC_WRITECTRL_WREN;
+
+    if ( result == mscReturnOk )
+      FlashTiming_Erased( FLASH_PAGE_SIZE );
+    else
+      FlashTiming_Stop();
   }
 
   return result == mscReturnOk ? 0 : 1;
 }
 
-/*****************************************************************************
- *  Program Page in Flash Memory
- *    Parameter:      adr:  Page Start Address
- *                    sz:   Page Size
- *                    buf:  Page Data
- *    Return Value:   0 - OK,  1 - Failed
- ****************************************************************************/
-uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
+static uint32_t PgmPage( uint32_t adr, uint32_t sz, uint32_t *buf )
 {
   uint32_t burst;
 
@@ -256,6 +270,25 @@ uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
   return 0;
 }
 
+/*****************************************************************************
+ *  Program Page in Flash Memory
+ *    Parameter:      adr:  Page Start Address
+ *                    sz:   Page Size
+ *                    buf:  Page Data
+ *    Return Value:   0 - OK,  1 - Failed
+ ****************************************************************************/
+uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
+{
+  FlashTiming_Start();
+  if ( PgmPage( adr, sz, buf ) != 0 )
+  {
+    FlashTiming_Stop();
+    return 1;
+  }
+  FlashTiming_Programmed( sz );
+  return 0;
+}
+
 /*
 uint32_t BlankCheck(uint32_t adr, uint32_t sz, uint8_t pat)
 {
@@ -98,6 +98,17 @@ typedef struct {
 #define FLASH_PSIZE_Word        ((unsigned int)0x00000200)
 #define FLASH_PSIZE_DoubleWord  ((unsigned int)0x00000300)
 
+// Erase parallelism, selected from the target supply voltage range
+#if   defined VOLTAGE_RANGE_4
+#define FLASH_PSIZE_Erase       FLASH_PSIZE_DoubleWord  // 2.7V - 3.6V with external Vpp
+#elif defined VOLTAGE_RANGE_3
+#define FLASH_PSIZE_Erase       FLASH_PSIZE_Word        // 2.7V - 3.6V
+#elif defined VOLTAGE_RANGE_2
+#define FLASH_PSIZE_Erase       FLASH_PSIZE_HalfWord    // 2.1V - 2.7V
+#else
+#define FLASH_PSIZE_Erase       FLASH_PSIZE_Byte        // 1.8V - 2.1V
+#endif
+
 
 // Flash Status Register definitions
 #define FLASH_EOP               ((unsigned int)0x00000001)
@@ -238,6 +249,7 @@ int UnInit (unsigned long fnc) {
 #ifdef FLASH_MEM
 int EraseChip (void) {
 
+  FLASH->CR  =  FLASH_PSIZE_Erase;                      // Erase Parallelism
   FLASH->CR |=  FLASH_MER;                              // Mass Erase Enabled (sectors  0..11)
 #ifdef STM32F4xx_2048
   FLASH->CR |=  FLASH_MER1;                             // Mass Erase Enabled (sectors 12..23)
@@ -297,6 +309,7 @@ int EraseSector (unsigned long adr) {
   FLASH->SR |= FLASH_PGERR;                             // Reset Error Flags
 
   FLASH->CR  =  FLASH_SER;                              // Sector Erase Enabled 
+  FLASH->CR |=  FLASH_PSIZE_Erase;                      // Erase Parallelism
   FLASH->CR |=  ((n << FLASH_SNB_POS) & FLASH_SNB_MSK); // Sector Number
   FLASH->CR |=  FLASH_STRT;                             // Start Erase
 
@@ -89,6 +89,7 @@ typedef struct {
 #define FLASH_ERASE            (0x00000200u)			// Page or Double Word erase mode
 #define FLASH_FPRG             (0x00000400u)			// Half Page/Double Word programming mode
 #define FLASH_GBHF_ER          (0x00000800u)			// Global Half Erase mode
+#define FLASH_PARALLBANK       (0x00008000u)			// Parallel bank mode
 
 // Flash status register (FLASH_SR) definitions
 #define FLASH_BSY              (0x00000001u)     // Write/erase operations in progress  
@@ -101,6 +102,14 @@ typedef struct {
 
 #define FLASH_ERRs         (FLASH_PGAERR | FLASH_WRPERR | FLASH_SIZERR | FLASH_OPTVERR)
 
+// Dual bank devices: a page or half page in each bank can be processed in one cycle
+#ifdef STM32L0xx_192
+#define FLASH_BANK1_BASE       (0x08000000u)     // Bank 1 start address
+#define FLASH_BANK2_BASE       (0x08018000u)     // Bank 2 start address
+#define FLASH_BANK_SIZE        (0x00018000u)     // Bank size (96kB)
+#define FLASH_PAGE_SIZE        (0x00000080u)     // Page size (128B)
+#endif
+
 // Option byte register (FLASH_OBR) definitions
 #define FLASH_IWDG_SW          (0x00100000u)            // Software IWDG or Hardware IWDG selected
 
@@ -228,6 +237,37 @@ int UnInit (unsigned long fnc) {
  *    Return Value:   0 - OK,  1 - Failed
  */
 
+#if defined FLASH_MEMORY && defined FLASH_BANK2_BASE
+int EraseChip (void) {
+  unsigned long adr;
+
+  FLASH->PECR |= FLASH_PARALLBANK;              // Parallel bank mode enabled
+  FLASH->PECR |= FLASH_ERASE;                   // Page or Double Word Erase enabled
+  FLASH->PECR |= FLASH_PROG;                    // Program memory selected
+
+  for (adr = FLASH_BANK1_BASE; adr < FLASH_BANK2_BASE; adr += FLASH_PAGE_SIZE) {
+    M32(adr) = 0x00000000;                      // erase page in bank 1 ...
+    M32(adr + FLASH_BANK_SIZE) = 0x00000000;    // ... and page in bank 2 in the same cycle
+
+    while (FLASH->SR & FLASH_BSY) {
+      IWDG->KR = 0xAAAA;                        // Reload IWDG
+    }
+
+    if (FLASH->SR & (FLASH_ERRs)) {             // Check for Errors
+      FLASH->SR |= FLASH_ERRs;                  // clear error flags
+      FLASH->PECR &= ~(FLASH_PARALLBANK | FLASH_ERASE | FLASH_PROG);
+      return (1);                               // Failed
+    }
+  }
+
+  FLASH->PECR &= ~FLASH_ERASE;                  // Page or Double Word Erase disabled
+  FLASH->PECR &= ~FLASH_PROG;                   // Program memory deselected
+  FLASH->PECR &= ~FLASH_PARALLBANK;             // Parallel bank mode disabled
+
+  return (0);                                   // Done
+}
+#endif  // FLASH_MEMORY && FLASH_BANK2_BASE
+
 #ifdef FLASH_OPTION
 int EraseChip (void) {
 
@@ -350,35 +390,71 @@ int BlankCheck (unsigned long adr, unsigned long sz, unsigned char pat) {
 #ifdef FLASH_MEMORY
 int ProgramPage (unsigned long adr, unsigned long sz, unsigned char *buf) {
   unsigned long  cnt;
-  unsigned long i;
+  unsigned long  n1, n2;                        // Half Pages to program in bank 1 / bank 2
+  unsigned long  adr2;
+  unsigned char *buf2;
 
   sz = (sz + 63) & ~63;                        // adjust programming size
 
-  for (i = 0; i < (sz / 64); i++) {
+  n1 = sz / 64;
+  n2 = 0;
+#ifdef FLASH_BANK2_BASE
+  if ((adr < FLASH_BANK2_BASE) && ((adr + sz) > FLASH_BANK2_BASE)) {
+    n2  = (adr + sz - FLASH_BANK2_BASE) / 64;  // part of the page located in bank 2
+    n1 -= n2;
+  }
+#endif
+  adr2 = adr + (n1 * 64);
+  buf2 = buf + (n1 * 64);
+
+  while (n1 || n2) {
     FLASH->PECR |= FLASH_FPRG;                 // Half Page programming mode enabled
     FLASH->PECR |= FLASH_PROG;                 // Program memory selected
-                                               
-    cnt = 64;                                  
-    while (cnt ) {                             
-       M32(adr) = *((unsigned long *)buf);     // Program Word
-       adr += 4;                               
-       buf += 4;                               
-       cnt -= 4;                               
-    }                                          
-                                               
-    while (FLASH->SR & FLASH_BSY) {            
+#ifdef FLASH_BANK2_BASE
+    if (n1 && n2) {
+      FLASH->PECR |= FLASH_PARALLBANK;         // one Half Page per bank in the same cycle
+    }
+#endif
+
+    if (n1) {
+      cnt = 64;
+      while (cnt ) {
+         M32(adr) = *((unsigned long *)buf);   // Program Word
+         adr += 4;
+         buf += 4;
+         cnt -= 4;
+      }
+      n1--;
+    }
+
+    if (n2 && ((n1 == 0) || (FLASH->PECR & FLASH_PARALLBANK))) {
+      cnt = 64;
+      while (cnt ) {
+         M32(adr2) = *((unsigned long *)buf2); // Program Word
+         adr2 += 4;
+         buf2 += 4;
+         cnt  -= 4;
+      }
+      n2--;
+    }
+
+    while (FLASH->SR & FLASH_BSY) {
       IWDG->KR = 0xAAAA;                       // Reload IWDG
-    }                                          
-                                               
+    }
+
     if (FLASH->SR & (FLASH_ERRs)) {            // Check for Errors
       FLASH->SR |= FLASH_ERRs;                 // clear error flags
+      FLASH->PECR &= ~(FLASH_PARALLBANK | FLASH_FPRG | FLASH_PROG);
       return (1);                              // Failed
-    }                                          
-                                               
+    }
+
     FLASH->PECR &= ~FLASH_FPRG;                // Half Page programming mode disabled
-    FLASH->PECR &= ~FLASH_PROG;                // Program memory deselected   
-  }                                            
-                                               
+    FLASH->PECR &= ~FLASH_PROG;                // Program memory deselected
+#ifdef FLASH_BANK2_BASE
+    FLASH->PECR &= ~FLASH_PARALLBANK;          // Parallel bank mode disabled
+#endif
+  }
+
   return (0);                                   // Done
 }
 #endif  // FLASH_MEMORY
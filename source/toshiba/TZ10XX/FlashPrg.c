@@ -18,6 +18,9 @@
 
 #include "FlashOS.h"
 #include "FlashPrg.h"
+#include "FlashSparse.h"
+#include "FlashTiming.h"
+#include "FlashWait.h"
 
 /* 
  * TZ10xx on chip NOR flash support functions. 
@@ -27,6 +30,7 @@
 #define TIME_LIMIT          (8000)
 #define TIME_LIMIT_MS       (10000)
 #define CORE_CLOCK          (48000000)
+#define SECTOR_SIZE         (0x1000)    // 4kB erase (0x20), see FlashDev.c
 
 #define REG_SPIC(offset)    (*((volatile uint32_t *)(SPIC_BASE_ADDR + (offset))))
 #define REG_GCNF(offset)    (*((volatile uint32_t *)(GCNF_BASE_ADDR + (offset))))
@@ -144,11 +148,79 @@ static int polling(void)
         if ((intr_stat & 0x00000001) == 0) {
             break;
         }
-        for (int i = 0; i < 100; i++);
+        // Every poll is a status command on the SPI bus
+        FlashWait_Idle();
     }
     return 0;
 }
 
+static int programRun(uint32_t adr, uint32_t sz, uint32_t *buf)
+{
+    uint32_t stat;
+    uint32_t offset;
+    uint32_t cnt;
+
+    // Write enable
+    if (prepareWrite() != 0) {
+        return 1;
+    }
+    
+    if (readStatus2(&stat) != 0) {
+        return 1;
+    }
+    if (stat & 0x00000002) {
+        /* SPI quad access mode. */
+        // Configuration of `PrgBufIOCtrl'
+        REG_SPIC(0x028) = 0x00000102;
+        // Configuration of `PrgOECtrl'
+        REG_SPIC(0x02C) = 0x00000400;
+        // Configuration of `PrgAccCtrl'
+        REG_SPIC(0x030) = (0x00030330 | ((sz - 1) << 24));
+        // Write `Write page program' command to SPIC PrimaryBuffer.
+        REG_SPIC(0x100) = (__rev(adr) | 0x32);
+    } else {
+        /* SPI single access mode. */
+        // Configuration of `PrgBufIOCtrl'
+        REG_SPIC(0x028) = 0x00000100;
+        // Configuration of `PrgOECtrl'
+        REG_SPIC(0x02C) = 0x00000400;
+        // Configuration of `PrgAccCtrl'
+        REG_SPIC(0x030) = (0x00030330 | ((sz - 1) << 24));
+        // Write `Write page program' command to SPIC PrimaryBuffer.
+        REG_SPIC(0x100) = (__rev(adr) | 0x02);
+    }
+    // Copy from SRAM to SPIC SecondaryBuffer.
+    offset = sz & 0xfffffffc;
+    for (int i = 0; i < sz; i += 4) {
+        REG_SPIC(0x200 + i) = buf[i >> 2];
+    }
+    if (offset != sz) {
+        REG_SPIC(0x200 + offset) = buf[offset >> 2];
+    }
+    if (sz < 224) {
+        wait(8 - (sz >> 5));
+    }
+    // Start
+    REG_SPIC(0x034) = 0x00000001;
+    // Wait for done.
+    for (cnt = TIME_LIMIT; cnt > 0; --cnt) {
+        if (REG_SPIC(0x0A0) & 0x00000002) {
+            // Detect PrgWrEnd flag.
+            break;
+        }
+    }
+    if (cnt == 0) {
+        // Timeout
+        return 1;
+    }
+    // Wait for BUSY flag cleard.
+    if (polling() != 0) {
+        return 1;
+    }
+
+    return 0;
+}
+
 /* FlashAlgo interface */
 
 uint32_t Init(uint32_t adr, uint32_t clk, uint32_t fnc)
@@ -169,17 +241,21 @@ uint32_t EraseChip(void)
 {
     uint32_t intr_stat;
     
+    FlashTiming_Start();
     if (prepareWrite() != 0) {
+        FlashTiming_Stop();
         return 1;
     }
     wait(8);
     // Write chip erase command.
     if (writeCommand(0x00000100, 0x00000310, 0x00000C7) != 0) {
+        FlashTiming_Stop();
         return 1;
     }
     // Wait 'BUSY' bit cleard.
     for (int i = 0; i < TIME_LIMIT_MS; i++) {
         if (readStatus1(&intr_stat) != 0) {
+            FlashTiming_Stop();
             return 1;
         }
         if ((intr_stat & 0x00000001) == 0) {
@@ -189,88 +265,44 @@ uint32_t EraseChip(void)
         wait(1000); // 1ms;
     }
     
+    FlashTiming_Erased(FLASH_TIMING_CHIP);
     return 0;
 }
 
 uint32_t EraseSector(uint32_t adr)
 {
+    FlashTiming_Start();
     if (prepareWrite() != 0) {
+        FlashTiming_Stop();
         return 1;
     }
     wait(8);
     // Write chip erase command.
     if (writeCommand(0x00000100, 0x00030310, (__rev(adr) | 0x20)) != 0) {
+        FlashTiming_Stop();
         return 1;
     }
     if (polling() != 0) {
+        FlashTiming_Stop();
         return 1;
     }
+    FlashTiming_Erased(SECTOR_SIZE);
     return 0;
 }
 
 uint32_t ProgramPage(uint32_t adr, uint32_t sz, uint32_t *buf)
 {
-    uint32_t stat;
-    uint32_t offset;
-    uint32_t cnt;
+    uint32_t ofs;
+    uint32_t len;
 
-    // Write enable
-    if (prepareWrite() != 0) {
-        return 1;
-    }
-    
-    if (readStatus2(&stat) != 0) {
-        return 1;
-    }
-    if (stat & 0x00000002) {
-        /* SPI quad access mode. */
-        // Configuration of `PrgBufIOCtrl'
-        REG_SPIC(0x028) = 0x00000102;
-        // Configuration of `PrgOECtrl'
-        REG_SPIC(0x02C) = 0x00000400;
-        // Configuration of `PrgAccCtrl'
-        REG_SPIC(0x030) = (0x00030330 | ((sz - 1) << 24));
-        // Write `Write page program' command to SPIC PrimaryBuffer.
-        REG_SPIC(0x100) = (__rev(adr) | 0x32);
-    } else {
-        /* SPI single access mode. */
-        // Configuration of `PrgBufIOCtrl'
-        REG_SPIC(0x028) = 0x00000100;
-        // Configuration of `PrgOECtrl'
-        REG_SPIC(0x02C) = 0x00000400;
-        // Configuration of `PrgAccCtrl'
-        REG_SPIC(0x030) = (0x00030330 | ((sz - 1) << 24));
-        // Write `Write page program' command to SPIC PrimaryBuffer.
-        REG_SPIC(0x100) = (__rev(adr) | 0x02);
-    }
-    // Copy from SRAM to SPIC SecondaryBuffer.
-    offset = sz & 0xfffffffc;
-    for (int i = 0; i < sz; i += 4) {
-        REG_SPIC(0x200 + i) = buf[i >> 2];
-    }
-    if (offset != sz) {
-        REG_SPIC(0x200 + offset) = buf[offset >> 2];
-    }
-    if (sz < 224) {
-        wait(8 - (sz >> 5));
-    }
-    // Start
-    REG_SPIC(0x034) = 0x00000001;
-    // Wait for done.
-    for (cnt = TIME_LIMIT; cnt > 0; --cnt) {
-        if (REG_SPIC(0x0A0) & 0x00000002) {
-            // Detect PrgWrEnd flag.
-            break;
+    FlashTiming_Start();
+    // Erased bytes are skipped, see FlashSparse.h
+    for (ofs = 0; (len = FlashSparse_NextRun((uint8_t *)buf, sz, &ofs)) != 0; ofs += len) {
+        if (programRun(adr + ofs, len, buf + (ofs >> 2)) != 0) {
+            FlashTiming_Stop();
+            return 1;
         }
     }
-    if (cnt == 0) {
-        // Timeout
-        return 1;
-    }
-    // Wait for BUSY flag cleard.
-    if (polling() != 0) {
-        return 1;
-    }
-
+    FlashTiming_Programmed(sz);
     return 0;
 }